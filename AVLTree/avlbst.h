@@ -1,403 +1,1022 @@
-#ifndef RBBST_H
-#define RBBST_H
-
-#include <iostream>
-#include <exception>
-#include <cstdlib>
-#include <algorithm>
-#include "bst.h"
-
-struct KeyError { };
-
-/**
-* A special kind of node for an AVL tree, which adds the height as a data member, plus
-* other additional helper functions. You do NOT need to implement any functionality or
-* add additional data members or helper functions.
-*/
-template <typename Key, typename Value>
-class AVLNode : public Node<Key, Value>
-{
-public:
-    // Constructor/destructor.
-    AVLNode(const Key& key, const Value& value, AVLNode<Key, Value>* parent);
-    virtual ~AVLNode();
-
-    // Getter/setter for the node's height.
-    int getHeight () const;
-    void setHeight (int height);
-
-    // Getters for parent, left, and right. These need to be redefined since they
-    // return pointers to AVLNodes - not plain Nodes. See the Node class in bst.h
-    // for more information.
-    virtual AVLNode<Key, Value>* getParent() const override;
-    virtual AVLNode<Key, Value>* getLeft() const override;
-    virtual AVLNode<Key, Value>* getRight() const override;
-
-protected:
-    int height_;
-};
-
-
-/*
-  -------------------------------------------------
-  Begin implementations for the AVLNode class.
-  -------------------------------------------------
-*/
-
-/**
-* An explicit constructor to initialize the elements by calling the base class constructor
-*/
-template<class Key, class Value>
-AVLNode<Key, Value>::AVLNode(const Key& key, const Value& value, AVLNode<Key, Value> *parent) :
-    Node<Key, Value>(key, value, parent), height_(1)
-{
-
-}
-
-/**
-* A destructor which does nothing.
-*/
-template<class Key, class Value>
-AVLNode<Key, Value>::~AVLNode()
-{
-
-}
-
-/**
-* A getter for the height of a AVLNode.
-*/
-template<class Key, class Value>
-int AVLNode<Key, Value>::getHeight() const
-{
-    return height_;
-}
-
-/**
-* A setter for the height of a AVLNode.
-*/
-template<class Key, class Value>
-void AVLNode<Key, Value>::setHeight(int height)
-{
-    height_ = height;
-}
-
-/**
-* An overridden function for getting the parent since a static_cast is necessary to make sure
-* that our node is a AVLNode.
-*/
-template<class Key, class Value>
-AVLNode<Key, Value> *AVLNode<Key, Value>::getParent() const
-{
-    return static_cast<AVLNode<Key, Value>*>(this->parent_);
-}
-
-/**
-* Overridden for the same reasons as above.
-*/
-template<class Key, class Value>
-AVLNode<Key, Value> *AVLNode<Key, Value>::getLeft() const
-{
-    return static_cast<AVLNode<Key, Value>*>(this->left_);
-}
-
-/**
-* Overridden for the same reasons as above.
-*/
-template<class Key, class Value>
-AVLNode<Key, Value> *AVLNode<Key, Value>::getRight() const
-{
-    return static_cast<AVLNode<Key, Value>*>(this->right_);
-}
-
-
-/*
-  -----------------------------------------------
-  End implementations for the AVLNode class.
-  -----------------------------------------------
-*/
-
-
-template <class Key, class Value>
-class AVLTree : public BinarySearchTree<Key, Value>
-{
-public:
-    virtual void insert (const std::pair<const Key, Value> &new_item); 
-
-    virtual void remove(const Key& key);  
-protected:
-    virtual void nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2);
-
-    
-    // Add helper functions here
-    //updates heights in the tree given the node changed
-    void updateAndBalance(AVLNode<Key, Value>* changed);
-    //updates a single node's height
-    bool updateNodeHeight(AVLNode<Key, Value>* curr);
-    void leftRotate(AVLNode<Key, Value>* curr);
-    void rightRotate(AVLNode<Key, Value>* curr);
-    void rebalance(AVLNode<Key, Value>* curr);
-public:
-    virtual void erase(Key k);
-
-};
-
-/**
- * Added for compatability with map implementation
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::erase(Key k){
-    remove(k);
-}
-
-/**
- * The insert function
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::insert(const std::pair<const Key, Value> &keyValuePair)
-{
-    //case when tree is empty
-    if(BinarySearchTree<Key, Value>::empty()){
-        Node<Key, Value>* first = new AVLNode<Key, Value>(keyValuePair.first, keyValuePair.second, NULL);
-        BinarySearchTree<Key, Value>::root_ = first;
-        return;
-    }
-
-    Node<Key, Value>* curr = BinarySearchTree<Key, Value>::root_;
-    while(1){
-        if(curr->getKey() < keyValuePair.first){
-            if(curr->getRight() == NULL){
-                break;
-            }
-            curr = curr->getRight();
-        } else if(curr->getKey() > keyValuePair.first){
-            if(curr->getLeft() == NULL){
-                break;
-            }
-            curr = curr->getLeft();
-        //if equal, then overwrite the previous value with new
-        } else{
-            curr->setValue(keyValuePair.second);
-            return;
-        }
-    }
-    Node<Key, Value>* ans = new AVLNode<Key, Value>(keyValuePair.first, keyValuePair.second, static_cast<AVLNode<Key, Value>*>(curr));
-    if(curr->getKey() < keyValuePair.first){
-        curr->setRight(ans);
-    } else {
-        curr->setLeft(ans);
-    }
-    if(DEBUG){
-        std::cout << "This is the tree after inserting and before balancing: " << std::endl;
-        BinarySearchTree<Key, Value>::print();
-    }
-    updateAndBalance(static_cast<AVLNode<Key, Value>*>(ans));
-    return;
-}
-
-template<class Key, class Value>
-void AVLTree<Key, Value>:: remove(const Key& key)
-{
-    BinarySearchTree<Key, Value>::remove(key);
-    AVLNode<Key, Value>* parent = static_cast<AVLNode<Key, Value>*>(BinarySearchTree<Key, Value>::closestFind(key));
-    if(parent == NULL){ return;}
-    if(DEBUG){
-        std::cout << "removed: " << key << std::endl << "this is the tree after the remove and before rebalancing" << std::endl;
-        BinarySearchTree<Key, Value>::print();
-    }
-    if(!updateNodeHeight(parent)){
-        rebalance(parent);
-    }
-    updateAndBalance(parent);
-}
-
-template<class Key, class Value>
-void AVLTree<Key, Value>::nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2)
-{
-    BinarySearchTree<Key, Value>::nodeSwap(n1, n2);
-    int tempH = n1->getHeight();
-    n1->setHeight(n2->getHeight());
-    n2->setHeight(tempH);
-}
-
-
-/**
- * Updates a single node's height by using the height of it's children
- * return true is the node is balaced, false if it is unbalanced
- * */
-template<class Key, class Value>
-bool AVLTree<Key, Value>::updateNodeHeight(AVLNode<Key, Value>* curr){
-    int lsth = 0;
-    int rsth = 0;
-    if(curr->getLeft() != NULL){
-        lsth = curr->getLeft()->getHeight();
-    }
-    if(curr->getRight() != NULL){
-        rsth = curr->getRight()->getHeight();
-    }
-    if(lsth - rsth > 1 || lsth - rsth < -1){
-        return false;
-    }
-    curr->setHeight(std::max(lsth, rsth) + 1);
-    return true;
-}
-
-
-/**
- * updates heights in the tree given the node that was changed
- * Also balances tree while doing so
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::updateAndBalance(AVLNode<Key, Value>* changed){
-    if(changed->getParent() == NULL){
-        return;
-    }
-    int ph = changed->getParent()->getHeight();
-    //update parent height & if parent is still balanced
-    if(updateNodeHeight(changed->getParent())){
-        //if parents height didn't changed vs changed
-        if(ph != changed->getParent()->getHeight()){
-            updateAndBalance(changed->getParent());
-        }
-    //parent becomes unbalanced, balance
-    } else {
-        rebalance(changed->getParent());
-        updateAndBalance(changed);
-    }
-}
-
-/**
- * rebalances the tree by finding zig-zigs, and zig-zags, and using left and right rotate
- * GIVEN - curr is the node that is unbalanced
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::rebalance(AVLNode<Key, Value>* curr){
-    enum direction {left, right};
-    //order[0] is the direciton where the bigger first child is (left or right)
-    //order[1] is the direction where the bigger second child is (left or right)
-    int order [2];
-
-    AVLNode<Key, Value>* temp = curr;
-    AVLNode<Key, Value>* bigger;
-    //goes down 2 levels
-    for(int i = 0 ; i < 2 ; i++){
-        int lsth = 0;
-        int rsth = 0;
-        if(temp->getLeft() != NULL){ lsth = temp->getLeft()->getHeight();}
-        if(temp->getRight() != NULL){ rsth = temp->getRight()->getHeight();}
-
-        if(lsth > rsth){
-            order[i] = left;
-            bigger = temp->getLeft();
-        } else {
-            order[i] = right;
-            bigger = temp->getRight();
-        }
-        temp = bigger;
-    }
-
-    //zig left zig left
-    if(order[0] == left && order[1] == left){
-        rightRotate(curr);
-
-    //zig left zag right
-    } else if(order[0] == left && order[1] == right){
-        leftRotate(curr->getLeft());
-        rightRotate(curr);
-
-    //zig right zag left
-    } else if(order[0] == right && order[1] == left){
-        rightRotate(curr->getRight());
-        leftRotate(curr);
-
-    //zig right zig right
-    } else if(order[0] == right && order[1] == right){
-        leftRotate(curr);
-    }
-}
-
-/**
- * This function does the right rotate on the node given
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::rightRotate(AVLNode<Key, Value>* curr){
-    //case wherre right rotate cannot be done
-    if(curr->getLeft() == NULL){
-        return;
-    }
-    if(DEBUG){ std::cout << "Doing right rotate now on: " << curr->getKey() <<  std::endl;}
-    AVLNode<Key, Value>* lc = curr->getLeft();
-    if(curr->getParent() != NULL){
-        //parent reroute 
-        if(curr->getKey() > curr->getParent()->getKey()){
-            curr->getParent()->setRight(lc);
-        } else {
-            curr->getParent()->setLeft(lc);
-        }
-        lc->setParent(curr->getParent());
-    }
-    //curr adopts lc's rc
-    curr->setLeft(lc->getRight());
-    if(lc->getRight() != NULL){
-        lc->getRight()->setParent(curr);
-    }
-    //lc becomes curr's parent
-    lc->setRight(curr);
-    curr->setParent(lc);
-    //change root if necessary
-    if(BinarySearchTree<Key, Value>::root_ == curr){
-        BinarySearchTree<Key, Value>::root_ = lc;
-        lc->setParent(NULL);
-    }
-    //update node heights
-    updateNodeHeight(curr); //right leg
-    updateNodeHeight(curr->getParent()); //parent
-    if(DEBUG){
-        std::cout << "printing tree now after right rotate: " << std::endl;
-        BinarySearchTree<Key, Value>::print();
-    }
-}
-
-/**
- * This function does the left rotate on the node given
- * */
-template<class Key, class Value>
-void AVLTree<Key, Value>::leftRotate(AVLNode<Key, Value>* curr){
-    //case wherre left rotate cannot be done
-    if(curr->getRight() == NULL){
-        return;
-    }
-    if(DEBUG){ std::cout << "Doing left rotate now on: " << curr->getKey() << std::endl;}
-    AVLNode<Key, Value>* rc = curr->getRight();
-    if(curr->getParent() != NULL){
-        //parent reroute 
-        if(curr->getKey() > curr->getParent()->getKey()){
-            curr->getParent()->setRight(rc);
-        } else {
-            curr->getParent()->setLeft(rc);
-        }
-        rc->setParent(curr->getParent());
-    }
-    //adopt rc's lc
-    curr->setRight(rc->getLeft());
-    if(rc->getLeft() != NULL){
-        rc->getLeft()->setParent(curr);
-    }
-    //rc becomes curr's parent
-    rc->setLeft(curr);
-    curr->setParent(rc);
-    //change root if necessary
-    if(BinarySearchTree<Key, Value>::root_ == curr){
-        BinarySearchTree<Key, Value>::root_ = rc;
-        rc->setParent(NULL);
-    }
-    //update node heights
-    updateNodeHeight(curr); //left leg
-    updateNodeHeight(curr->getParent()); //parent
-    if(DEBUG){
-        std::cout << "printing tree now after left rotate: " << std::endl;
-        BinarySearchTree<Key, Value>::print();
-    }
-
-}
-
-#endif
+#ifndef RBBST_H
+#define RBBST_H
+
+#include <iostream>
+#include <exception>
+#include <cstdlib>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <future>
+#include <thread>
+#include "bst.h"
+
+struct KeyError { };
+
+//set operations only fork when both inputs together have at least this many items
+const std::size_t AVL_PARALLEL_CUTOFF = 20000;
+
+/**
+* A special kind of node for an AVL tree, which adds the balance factor and the subtree size.
+* The parent/left/right getters come from BasicNode and already return AVLNodes.
+*
+* The balance factor (height of the right subtree minus height of the left subtree,
+* -1, 0 or 1 in a valid AVL tree) is kept in the two tag bits of the parent link.
+* The size (number of nodes in the subtree rooted here) is what rank/select walk down on.
+*/
+template <typename Key, typename Value>
+class AVLNode : public BasicNode<Key, Value, AVLNode<Key, Value> >
+{
+public:
+    // Constructor.
+    AVLNode(const Key& key, const Value& value, AVLNode<Key, Value>* parent);
+
+    // Getter/setter for the node's balance factor, -1, 0 or 1.
+    int getBalance () const;
+    void setBalance (int balance);
+
+    // Getter/setter for the number of nodes in this subtree, this one included.
+    std::size_t getSize () const;
+    void setSize (std::size_t size);
+    //size of a subtree that may be empty
+    static std::size_t sizeOf(const AVLNode<Key, Value>* node);
+
+protected:
+    std::size_t size_;
+};
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for the AVLNode class.
+  -------------------------------------------------
+*/
+
+/**
+* An explicit constructor to initialize the elements by calling the base class constructor
+* A new node is a leaf, so it is balanced
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>::AVLNode(const Key& key, const Value& value, AVLNode<Key, Value> *parent) :
+    BasicNode<Key, Value, AVLNode<Key, Value> >(key, value, parent),
+    size_(1)
+{
+    setBalance(0);
+}
+
+/**
+* A getter for the balance factor of a AVLNode.
+* The tag holds balance + 1 (0, 1 or 2)
+*/
+template<class Key, class Value>
+int AVLNode<Key, Value>::getBalance() const
+{
+    return (int)this->getTag() - 1;
+}
+
+/**
+* A setter for the balance factor of a AVLNode.
+*/
+template<class Key, class Value>
+void AVLNode<Key, Value>::setBalance(int balance)
+{
+    this->setTag(balance + 1);
+}
+
+template<class Key, class Value>
+std::size_t AVLNode<Key, Value>::getSize() const
+{
+    return size_;
+}
+
+template<class Key, class Value>
+void AVLNode<Key, Value>::setSize(std::size_t size)
+{
+    size_ = size;
+}
+
+template<class Key, class Value>
+std::size_t AVLNode<Key, Value>::sizeOf(const AVLNode<Key, Value>* node)
+{
+    return node == NULL ? 0 : node->getSize();
+}
+
+
+/*
+  -----------------------------------------------
+  End implementations for the AVLNode class.
+  -----------------------------------------------
+*/
+
+
+/**
+* Alloc is rebound to AVLNode, see BinarySearchTree for the default pool allocator.
+*/
+template <class Key, class Value, class Alloc = PoolAllocator<std::pair<const Key, Value> > >
+class AVLTree : public BinarySearchTree<Key, Value, Alloc, AVLNode<Key, Value> >
+{
+protected:
+    typedef BinarySearchTree<Key, Value, Alloc, AVLNode<Key, Value> > BST;
+public:
+    virtual void remove(const Key& key) override;
+
+    // Order statistics, all O(log n) through the subtree sizes
+    std::size_t size() const;
+    //number of keys smaller than key
+    std::size_t rank(const Key& key) const;
+    //the item with the k-th smallest key (k = 0 is the smallest), end() if k >= size()
+    typename BST::iterator select(std::size_t k) const;
+    //number of keys in [lo, hi)
+    std::size_t countRange(const Key& lo, const Key& hi) const;
+
+    // Join and split
+    //adds (key, value) and then all of right's items, right is left empty. Every key here must be
+    //smaller than key, and key smaller than every key in right. O(log n), right's nodes move here
+    void join(const Key& key, const Value& value, AVLTree<Key, Value, Alloc>& right);
+    //moves every item with a key >= key to greater, whose items are removed first. O(log n), the
+    //nodes move as they are and greater gets a copy of this tree's allocator (with the pool both
+    //trees then share one pool)
+    void split(const Key& key, AVLTree<Key, Value, Alloc>& greater);
+
+    // Set operations, O(m log(n/m + 1)) for sizes m <= n, forking threads for big inputs
+    //adds other's items whose keys are missing here. Keys in both keep the value they have here
+    void unionWith(const AVLTree<Key, Value, Alloc>& other);
+    //keeps only the items whose keys are in other too
+    void intersectWith(const AVLTree<Key, Value, Alloc>& other);
+    //removes the items whose keys are in other
+    void subtract(const AVLTree<Key, Value, Alloc>& other);
+protected:
+    //counts the new leaf in the sizes above it and rebalances
+    virtual void insertedLeaf(AVLNode<Key, Value>* leaf) override;
+    //swaps the balance factors and sizes too
+    virtual void nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2) override;
+
+
+    // Add helper functions here
+    //walks up from a node whose subtree just got one taller, fixing balance factors
+    void updateAndBalance(AVLNode<Key, Value>* changed);
+    //walks up from parent, whose left or right subtree just got one shorter
+    void shrinkAndBalance(AVLNode<Key, Value>* parent, bool leftShrank);
+    void leftRotate(AVLNode<Key, Value>* curr);
+    void rightRotate(AVLNode<Key, Value>* curr);
+    //adds delta to the size of node and of every node above it
+    void addToSizes(AVLNode<Key, Value>* node, int delta);
+    //rotates the subtree at curr, whose balance factor is balance (-2 or 2)
+    AVLNode<Key, Value>* rebalance(AVLNode<Key, Value>* curr, int balance, bool& shrank);
+    //bulk loads come out balanced, this only stores the balance factor and size
+    virtual void setBuiltHeights(AVLNode<Key, Value>* node, int leftHeight, int rightHeight) override;
+
+    //a subtree taken out of the tree (or about to be linked in) and its height. Join and split
+    //work on these, they need heights and nodes only keep balance factors
+    struct Subtree
+    {
+        AVLNode<Key, Value>* root;
+        int height;
+    };
+    static int heightOf(const AVLNode<Key, Value>* node);
+    //height of node's left or right subtree, from node's height and balance factor
+    static int childHeight(const AVLNode<Key, Value>* node, int height, bool right);
+    static Subtree leftOf(const Subtree& tree);
+    static Subtree rightOf(const Subtree& tree);
+    //makes left and right node's children, which must differ in height by at most 1
+    static Subtree attach(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right);
+    //attach, with a rotation if right ended up two taller than left (or the other way around)
+    static Subtree attachRotatingLeft(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right);
+    static Subtree attachRotatingRight(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right);
+    //all of left's keys < middle's key < all of right's keys, of any heights
+    static Subtree joinTrees(const Subtree& left, AVLNode<Key, Value>* middle, const Subtree& right);
+    //join without a middle node, the largest node of left takes its place
+    static Subtree joinTrees(const Subtree& left, const Subtree& right);
+    //less gets the keys < key and greater the keys > key, returns the node with key (unlinked) or NULL
+    static AVLNode<Key, Value>* splitTree(const Subtree& tree, const Key& key, Subtree& less, Subtree& greater);
+
+    //what one set operation shares between its threads
+    struct SetOperation
+    {
+        const AVLTree<Key, Value, Alloc>* other;
+        //no more forking this deep in the recursion
+        int forkDepth;
+    };
+    //runs both, at the same time if fork is set
+    template<class LeftFn, class RightFn>
+    static void forkJoin(bool fork, LeftFn left, RightFn right);
+    bool shouldFork(const SetOperation& op, const Subtree& mine, const AVLNode<Key, Value>* theirs, int depth) const;
+    //theirs is a subtree of other with its height, new nodes come from alloc
+    Subtree unionSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, typename BST::NodeAlloc& alloc, int depth);
+    Subtree copySubtree(const AVLNode<Key, Value>* theirs, int theirHeight, typename BST::NodeAlloc& alloc);
+    static AVLNode<Key, Value>* copyNode(const AVLNode<Key, Value>* theirs, typename BST::NodeAlloc& alloc);
+    //nodes taken out go to dropped, and are freed after all threads are done
+    Subtree intersectSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, std::vector<AVLNode<Key, Value>*>& dropped, int depth);
+    Subtree subtractSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, std::vector<AVLNode<Key, Value>*>& dropped, int depth);
+    void startSetOperation(SetOperation& op, const AVLTree<Key, Value, Alloc>& other) const;
+    //makes result the tree and frees what was dropped
+    void finishSetOperation(const Subtree& result, std::vector<AVLNode<Key, Value>*>& dropped);
+    void destroySubtree(AVLNode<Key, Value>* node);
+public:
+    virtual void erase(Key k);
+
+};
+
+/**
+ * Added for compatability with map implementation
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::erase(Key k){
+    remove(k);
+}
+
+/**
+ * Every insert (insert, try_emplace, upsert) goes through the BST's descent, which calls this
+ * once the new leaf is linked in: the nodes above it count one more node, then the retrace
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::insertedLeaf(AVLNode<Key, Value>* leaf)
+{
+    addToSizes(leaf->getParent(), 1);
+    if(DEBUG){
+        std::cout << "This is the tree after inserting and before balancing: " << std::endl;
+        BST::print();
+    }
+    updateAndBalance(leaf);
+}
+
+/**
+ * Removes the node with the key, if there is one
+ * A node with two children is first swapped with its predecessor, so the node that is
+ * unlinked always has at most one child, and its parent's subtree on that side got one shorter
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>:: remove(const Key& key)
+{
+    AVLNode<Key, Value>* pos = BST::internalFind(key);
+    if(pos == NULL){ return;}
+    if(pos == BST::rightmost_){
+        BST::rightmost_ = BST::predecessor(pos);
+    }
+    if(pos->getLeft() != NULL && pos->getRight() != NULL){
+        nodeSwap(pos, BST::predecessor(pos));
+    }
+    AVLNode<Key, Value>* child = pos->getLeft() != NULL ? pos->getLeft() : pos->getRight();
+    AVLNode<Key, Value>* parent = pos->getParent();
+    bool leftShrank = parent != NULL && parent->getLeft() == pos;
+    if(child != NULL){
+        child->setParent(parent);
+    }
+    if(parent == NULL){
+        BST::root_ = child;
+    } else if(leftShrank){
+        parent->setLeft(child);
+    } else {
+        parent->setRight(child);
+    }
+    addToSizes(parent, -1);
+    BST::destroyNode(pos);
+    if(DEBUG){
+        std::cout << "this is the tree after the remove and before rebalancing" << std::endl;
+        BST::print();
+    }
+    shrinkAndBalance(parent, leftShrank);
+}
+
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2)
+{
+    BST::nodeSwap(n1, n2);
+    int tempB = n1->getBalance();
+    n1->setBalance(n2->getBalance());
+    n2->setBalance(tempB);
+    std::size_t tempS = n1->getSize();
+    n1->setSize(n2->getSize());
+    n2->setSize(tempS);
+}
+
+/**
+ * Walks up to the root, so it is O(log n). Rotations keep the sizes right on their own,
+ * this is only for the nodes above an insert or remove
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::addToSizes(AVLNode<Key, Value>* node, int delta)
+{
+    for( ; node != NULL ; node = node->getParent()){
+        node->setSize(node->getSize() + delta);
+    }
+}
+
+template<class Key, class Value, class Alloc>
+std::size_t AVLTree<Key, Value, Alloc>::size() const
+{
+    return AVLNode<Key, Value>::sizeOf(BST::root_);
+}
+
+/**
+ * Going right past a node skips it and its whole left subtree, which all have smaller keys
+ * runtime = O(log n)
+ * */
+template<class Key, class Value, class Alloc>
+std::size_t AVLTree<Key, Value, Alloc>::rank(const Key& key) const
+{
+    std::size_t smaller = 0;
+    AVLNode<Key, Value>* curr = BST::root_;
+    while(curr != NULL){
+        if(curr->getKey() < key){
+            smaller += AVLNode<Key, Value>::sizeOf(curr->getLeft()) + 1;
+            curr = curr->getRight();
+        } else {
+            curr = curr->getLeft();
+        }
+    }
+    return smaller;
+}
+
+/**
+ * The left subtree's size says whether the k-th key is on the left, here, or on the right
+ * runtime = O(log n)
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::BST::iterator AVLTree<Key, Value, Alloc>::select(std::size_t k) const
+{
+    AVLNode<Key, Value>* curr = BST::root_;
+    while(curr != NULL){
+        std::size_t left = AVLNode<Key, Value>::sizeOf(curr->getLeft());
+        if(k < left){
+            curr = curr->getLeft();
+        } else if(k == left){
+            break;
+        } else {
+            k -= left + 1;
+            curr = curr->getRight();
+        }
+    }
+    return BST::makeIterator(curr);
+}
+
+/**
+ * Two ranks, so O(log n) however many keys are in the range
+ * */
+template<class Key, class Value, class Alloc>
+std::size_t AVLTree<Key, Value, Alloc>::countRange(const Key& lo, const Key& hi) const
+{
+    if(!(lo < hi)){
+        return 0;
+    }
+    return rank(hi) - rank(lo);
+}
+
+
+/**
+ * The new node goes at the bottom of left's right spine (or right's left spine), where it
+ * is about as tall as the other tree, and the spine is rebalanced on the way back up.
+ * Appends right's nodes as they are, so with the pool this pool takes over right's chunks
+ * runtime = O(log n)
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::join(const Key& key, const Value& value, AVLTree<Key, Value, Alloc>& right)
+{
+    if(&right == this){
+        return;
+    }
+    AVLNode<Key, Value>* middle = BST::createNode(key, value, NULL);
+    adoptAll(BST::nodeAlloc_, right.nodeAlloc_);
+    Subtree left = { BST::root_, heightOf(BST::root_) };
+    Subtree rightTree = { right.root_, heightOf(right.root_) };
+    BST::root_ = joinTrees(left, middle, rightTree).root;
+    BST::rightmost_ = right.root_ != NULL ? right.rightmost_ : middle;
+    right.root_ = NULL;
+    right.rightmost_ = NULL;
+}
+
+/**
+ * Splits along the path down to key: everything left of the path joins into the smaller
+ * half and everything right of it into the greater half, O(log n) joins that add up to O(log n)
+ * The greater half keeps its nodes. Copies of an allocator can free each other's memory, so
+ * greater takes a copy of this tree's allocator. With the pool that means both trees use the
+ * same pool from now on, until one of them is cleared
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::split(const Key& key, AVLTree<Key, Value, Alloc>& greater)
+{
+    if(&greater == this){
+        return;
+    }
+    greater.clear();
+    Subtree whole = { BST::root_, heightOf(BST::root_) };
+    Subtree less, more;
+    AVLNode<Key, Value>* found = splitTree(whole, key, less, more);
+    if(found != NULL){
+        //key itself is the smallest key of the greater half
+        Subtree none = { NULL, 0 };
+        more = joinTrees(none, found, more);
+    }
+    BST::root_ = less.root;
+    if(BST::root_ != NULL){
+        BST::root_->setParent(NULL);
+    }
+    BST::rightmost_ = BST::getLargestNode();
+    if(more.root == NULL){
+        return;
+    }
+    more.root->setParent(NULL);
+    greater.nodeAlloc_ = BST::nodeAlloc_;
+    greater.root_ = more.root;
+    greater.rightmost_ = greater.getLargestNode();
+}
+
+/**
+ * Split this tree by other's root, union the halves with other's subtrees (both at once on
+ * another thread when big enough) and join the results back with the root. The keys that
+ * are only in other get new nodes. A forked thread allocates them from an allocator of its
+ * own (a new pool), which is adopted by the allocator it was forked from once it is done
+ * runtime = O(m log(n/m + 1))
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::unionWith(const AVLTree<Key, Value, Alloc>& other)
+{
+    if(&other == this || other.root_ == NULL){
+        return;
+    }
+    SetOperation op;
+    startSetOperation(op, other);
+    Subtree mine = { BST::root_, heightOf(BST::root_) };
+    Subtree result = unionSubtree(op, mine, other.root_, heightOf(other.root_), BST::nodeAlloc_, 0);
+    std::vector<AVLNode<Key, Value>*> dropped;
+    finishSetOperation(result, dropped);
+}
+
+/**
+ * Same recursion as unionWith(), but a subtree of this tree is dropped whole as soon as
+ * other has nothing left in its key range, and a root that other doesn't have is left out
+ * of the join
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::intersectWith(const AVLTree<Key, Value, Alloc>& other)
+{
+    if(&other == this){
+        return;
+    }
+    SetOperation op;
+    startSetOperation(op, other);
+    std::vector<AVLNode<Key, Value>*> dropped;
+    Subtree mine = { BST::root_, heightOf(BST::root_) };
+    Subtree result = intersectSubtree(op, mine, other.root_, heightOf(other.root_), dropped, 0);
+    finishSetOperation(result, dropped);
+}
+
+/**
+ * Same recursion again, the node with other's root key is dropped
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::subtract(const AVLTree<Key, Value, Alloc>& other)
+{
+    if(&other == this){
+        BST::clear();
+        return;
+    }
+    SetOperation op;
+    startSetOperation(op, other);
+    std::vector<AVLNode<Key, Value>*> dropped;
+    Subtree mine = { BST::root_, heightOf(BST::root_) };
+    Subtree result = subtractSubtree(op, mine, other.root_, heightOf(other.root_), dropped, 0);
+    finishSetOperation(result, dropped);
+}
+
+/**
+ * The balance factor says which child is taller, so the height is the length of the path
+ * that always goes to the taller child
+ * runtime = O(log n)
+ * */
+template<class Key, class Value, class Alloc>
+int AVLTree<Key, Value, Alloc>::heightOf(const AVLNode<Key, Value>* node)
+{
+    int height = 0;
+    while(node != NULL){
+        height++;
+        node = node->getBalance() > 0 ? node->getRight() : node->getLeft();
+    }
+    return height;
+}
+
+template<class Key, class Value, class Alloc>
+int AVLTree<Key, Value, Alloc>::childHeight(const AVLNode<Key, Value>* node, int height, bool right)
+{
+    int balance = node->getBalance();
+    return height - 1 - ((right ? balance < 0 : balance > 0) ? 1 : 0);
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree AVLTree<Key, Value, Alloc>::leftOf(const Subtree& tree)
+{
+    Subtree left = { tree.root->getLeft(), childHeight(tree.root, tree.height, false) };
+    return left;
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree AVLTree<Key, Value, Alloc>::rightOf(const Subtree& tree)
+{
+    Subtree right = { tree.root->getRight(), childHeight(tree.root, tree.height, true) };
+    return right;
+}
+
+/**
+ * Sets the links both ways, the balance factor and the size. node ends up with no parent,
+ * whoever attaches it next sets that
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::attach(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right)
+{
+    node->setLeft(left.root);
+    node->setRight(right.root);
+    if(left.root != NULL){ left.root->setParent(node); }
+    if(right.root != NULL){ right.root->setParent(node); }
+    node->setParent(NULL);
+    node->setBalance(right.height - left.height);
+    node->setSize(AVLNode<Key, Value>::sizeOf(left.root) + AVLNode<Key, Value>::sizeOf(right.root) + 1);
+    Subtree tree = { node, std::max(left.height, right.height) + 1 };
+    return tree;
+}
+
+/**
+ * right is at most two taller than left. Then right's inner child decides between a single
+ * and a double rotation, like in rebalance(), except that here the children's heights are known
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::attachRotatingLeft(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right)
+{
+    if(right.height <= left.height + 1){
+        return attach(node, left, right);
+    }
+    Subtree inner = leftOf(right);
+    Subtree outer = rightOf(right);
+    if(inner.height <= outer.height){
+        return attach(right.root, attach(node, left, inner), outer);
+    }
+    Subtree innerLeft = leftOf(inner);
+    Subtree innerRight = rightOf(inner);
+    return attach(inner.root, attach(node, left, innerLeft), attach(right.root, innerRight, outer));
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::attachRotatingRight(AVLNode<Key, Value>* node, const Subtree& left, const Subtree& right)
+{
+    if(left.height <= right.height + 1){
+        return attach(node, left, right);
+    }
+    Subtree inner = rightOf(left);
+    Subtree outer = leftOf(left);
+    if(inner.height <= outer.height){
+        return attach(left.root, outer, attach(node, inner, right));
+    }
+    Subtree innerLeft = leftOf(inner);
+    Subtree innerRight = rightOf(inner);
+    return attach(inner.root, attach(left.root, outer, innerLeft), attach(node, innerRight, right));
+}
+
+/**
+ * When one tree is more than one taller, walks down its inner spine until the subtree there
+ * is about as tall as the other tree, puts middle on top of the two, and rotates on the way
+ * back up wherever the spine got two taller than the other side
+ * runtime = O(difference in height + 1)
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::joinTrees(const Subtree& left, AVLNode<Key, Value>* middle, const Subtree& right)
+{
+    if(left.height > right.height + 1){
+        Subtree outer = leftOf(left);
+        Subtree joined = joinTrees(rightOf(left), middle, right);
+        return attachRotatingLeft(left.root, outer, joined);
+    }
+    if(right.height > left.height + 1){
+        Subtree outer = rightOf(right);
+        Subtree joined = joinTrees(left, middle, leftOf(right));
+        return attachRotatingRight(right.root, joined, outer);
+    }
+    return attach(middle, left, right);
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::joinTrees(const Subtree& left, const Subtree& right)
+{
+    if(left.root == NULL){
+        return right;
+    }
+    AVLNode<Key, Value>* largest = left.root;
+    while(largest->getRight() != NULL){
+        largest = largest->getRight();
+    }
+    Subtree rest, nothing;
+    splitTree(left, largest->getKey(), rest, nothing);
+    return joinTrees(rest, largest, right);
+}
+
+/**
+ * runtime = O(log n): the joins on the way back up each cost the difference in height of
+ * the pieces they join, and those add up along the path
+ * */
+template<class Key, class Value, class Alloc>
+AVLNode<Key, Value>* AVLTree<Key, Value, Alloc>::splitTree(const Subtree& tree, const Key& key, Subtree& less, Subtree& greater)
+{
+    if(tree.root == NULL){
+        less = tree;
+        greater = tree;
+        return NULL;
+    }
+    AVLNode<Key, Value>* node = tree.root;
+    Subtree left = leftOf(tree);
+    Subtree right = rightOf(tree);
+    Subtree middle;
+    if(key < node->getKey()){
+        AVLNode<Key, Value>* found = splitTree(left, key, less, middle);
+        greater = joinTrees(middle, node, right);
+        return found;
+    }
+    if(node->getKey() < key){
+        AVLNode<Key, Value>* found = splitTree(right, key, middle, greater);
+        less = joinTrees(left, node, middle);
+        return found;
+    }
+    less = left;
+    greater = right;
+    return node;
+}
+
+template<class Key, class Value, class Alloc>
+template<class LeftFn, class RightFn>
+void AVLTree<Key, Value, Alloc>::forkJoin(bool fork, LeftFn left, RightFn right)
+{
+    if(!fork){
+        left();
+        right();
+        return;
+    }
+    std::future<void> leftDone = std::async(std::launch::async, left);
+    right();
+    leftDone.get();
+}
+
+/**
+ * Forks only near the top of the recursion, about two tasks per hardware thread, and only
+ * while the inputs are big enough to pay for starting a thread
+ * */
+template<class Key, class Value, class Alloc>
+bool AVLTree<Key, Value, Alloc>::shouldFork(const SetOperation& op, const Subtree& mine, const AVLNode<Key, Value>* theirs, int depth) const
+{
+    return depth < op.forkDepth && AVLNode<Key, Value>::sizeOf(mine.root) + AVLNode<Key, Value>::sizeOf(theirs) >= AVL_PARALLEL_CUTOFF;
+}
+
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::startSetOperation(SetOperation& op, const AVLTree<Key, Value, Alloc>& other) const
+{
+    op.other = &other;
+    unsigned int threads = std::thread::hardware_concurrency();
+    op.forkDepth = 0;
+    if(threads > 1){
+        while((1u << op.forkDepth) < 2 * threads){
+            op.forkDepth++;
+        }
+    }
+}
+
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::finishSetOperation(const Subtree& result, std::vector<AVLNode<Key, Value>*>& dropped)
+{
+    for(std::size_t i = 0 ; i < dropped.size() ; i++){
+        destroySubtree(dropped[i]);
+    }
+    BST::root_ = result.root;
+    if(BST::root_ != NULL){
+        BST::root_->setParent(NULL);
+    }
+    BST::rightmost_ = BST::getLargestNode();
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::unionSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, typename BST::NodeAlloc& alloc, int depth)
+{
+    if(theirs == NULL){
+        return mine;
+    }
+    if(mine.root == NULL){
+        return copySubtree(theirs, theirHeight, alloc);
+    }
+    Subtree less, greater, left, right;
+    AVLNode<Key, Value>* found = splitTree(mine, theirs->getKey(), less, greater);
+    bool fork = shouldFork(op, mine, theirs, depth);
+    //the left half runs on the new thread, with an allocator of its own
+    std::unique_ptr<typename BST::NodeAlloc> leftAlloc;
+    if(fork){
+        leftAlloc.reset(new typename BST::NodeAlloc(separateAllocator(alloc)));
+    }
+    forkJoin(fork,
+        [&](){ left = unionSubtree(op, less, theirs->getLeft(), childHeight(theirs, theirHeight, false), fork ? *leftAlloc : alloc, depth + 1); },
+        [&](){ right = unionSubtree(op, greater, theirs->getRight(), childHeight(theirs, theirHeight, true), alloc, depth + 1); });
+    if(fork){
+        adoptAll(alloc, *leftAlloc);
+    }
+    if(found == NULL){
+        found = copyNode(theirs, alloc);
+    }
+    return joinTrees(left, found, right);
+}
+
+/**
+ * Copies node for node, so the copy has the same shape and balance factors
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::copySubtree(const AVLNode<Key, Value>* theirs, int theirHeight, typename BST::NodeAlloc& alloc)
+{
+    if(theirs == NULL){
+        Subtree empty = { NULL, 0 };
+        return empty;
+    }
+    Subtree left = copySubtree(theirs->getLeft(), childHeight(theirs, theirHeight, false), alloc);
+    AVLNode<Key, Value>* node = copyNode(theirs, alloc);
+    Subtree right = copySubtree(theirs->getRight(), childHeight(theirs, theirHeight, true), alloc);
+    return attach(node, left, right);
+}
+
+template<class Key, class Value, class Alloc>
+AVLNode<Key, Value>* AVLTree<Key, Value, Alloc>::copyNode(const AVLNode<Key, Value>* theirs, typename BST::NodeAlloc& alloc)
+{
+    AVLNode<Key, Value>* node = std::allocator_traits<typename BST::NodeAlloc>::allocate(alloc, 1);
+    std::allocator_traits<typename BST::NodeAlloc>::construct(alloc, node, theirs->getKey(), theirs->getValue(), (AVLNode<Key, Value>*)NULL);
+    return node;
+}
+
+/**
+ * With a fork, the right half collects its dropped nodes on its own and hands them over after
+ * */
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::intersectSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, std::vector<AVLNode<Key, Value>*>& dropped, int depth)
+{
+    if(mine.root == NULL){
+        return mine;
+    }
+    if(theirs == NULL){
+        dropped.push_back(mine.root);
+        Subtree empty = { NULL, 0 };
+        return empty;
+    }
+    Subtree less, greater, left, right;
+    AVLNode<Key, Value>* found = splitTree(mine, theirs->getKey(), less, greater);
+    bool fork = shouldFork(op, mine, theirs, depth);
+    std::vector<AVLNode<Key, Value>*> rightDropped;
+    forkJoin(fork,
+        [&](){ left = intersectSubtree(op, less, theirs->getLeft(), childHeight(theirs, theirHeight, false), dropped, depth + 1); },
+        [&](){ right = intersectSubtree(op, greater, theirs->getRight(), childHeight(theirs, theirHeight, true), fork ? rightDropped : dropped, depth + 1); });
+    dropped.insert(dropped.end(), rightDropped.begin(), rightDropped.end());
+    if(found != NULL){
+        return joinTrees(left, found, right);
+    }
+    return joinTrees(left, right);
+}
+
+template<class Key, class Value, class Alloc>
+typename AVLTree<Key, Value, Alloc>::Subtree
+AVLTree<Key, Value, Alloc>::subtractSubtree(SetOperation& op, Subtree mine, const AVLNode<Key, Value>* theirs, int theirHeight, std::vector<AVLNode<Key, Value>*>& dropped, int depth)
+{
+    if(mine.root == NULL || theirs == NULL){
+        return mine;
+    }
+    Subtree less, greater, left, right;
+    AVLNode<Key, Value>* found = splitTree(mine, theirs->getKey(), less, greater);
+    if(found != NULL){
+        found->setLeft(NULL);
+        found->setRight(NULL);
+        dropped.push_back(found);
+    }
+    bool fork = shouldFork(op, mine, theirs, depth);
+    std::vector<AVLNode<Key, Value>*> rightDropped;
+    forkJoin(fork,
+        [&](){ left = subtractSubtree(op, less, theirs->getLeft(), childHeight(theirs, theirHeight, false), dropped, depth + 1); },
+        [&](){ right = subtractSubtree(op, greater, theirs->getRight(), childHeight(theirs, theirHeight, true), fork ? rightDropped : dropped, depth + 1); });
+    dropped.insert(dropped.end(), rightDropped.begin(), rightDropped.end());
+    return joinTrees(left, right);
+}
+
+/**
+ * Frees one node at a time, unlike deleteAll() which leaves the memory to the pool's release()
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::destroySubtree(AVLNode<Key, Value>* node)
+{
+    if(node == NULL){
+        return;
+    }
+    destroySubtree(node->getLeft());
+    destroySubtree(node->getRight());
+    BST::destroyNode(node);
+}
+
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::setBuiltHeights(AVLNode<Key, Value>* node, int leftHeight, int rightHeight)
+{
+    node->setBalance(rightHeight - leftHeight);
+    node->setSize(AVLNode<Key, Value>::sizeOf(node->getLeft()) + AVLNode<Key, Value>::sizeOf(node->getRight()) + 1);
+}
+
+
+/**
+ * Retracing after an insert: changed's subtree is one taller than before
+ * Each step only looks at the parent's balance factor. It stops as soon as a subtree's height
+ * is unchanged: when the parent was leaning the other way, or after a rotation (which brings
+ * the subtree back to its old height)
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::updateAndBalance(AVLNode<Key, Value>* changed){
+    AVLNode<Key, Value>* parent = changed->getParent();
+    while(parent != NULL){
+        int balance = parent->getBalance() + (parent->getLeft() == changed ? -1 : 1);
+        if(balance == 0){
+            //the shorter side caught up, parent's height did not change
+            parent->setBalance(0);
+            return;
+        }
+        if(balance == 2 || balance == -2){
+            bool shrank;
+            rebalance(parent, balance, shrank);
+            return;
+        }
+        //parent got one taller too
+        parent->setBalance(balance);
+        changed = parent;
+        parent = changed->getParent();
+    }
+}
+
+/**
+ * Retracing after a remove: parent's left (or right) subtree is one shorter than before
+ * Stops as soon as a subtree's height is unchanged. Unlike inserts, a rotation can leave the
+ * subtree one shorter, so the walk may continue up to the root
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::shrinkAndBalance(AVLNode<Key, Value>* parent, bool leftShrank){
+    while(parent != NULL){
+        int balance = parent->getBalance() + (leftShrank ? 1 : -1);
+        AVLNode<Key, Value>* subtree = parent;
+        if(balance == 1 || balance == -1){
+            //was balanced, the other side still holds the height
+            parent->setBalance(balance);
+            return;
+        }
+        if(balance == 0){
+            parent->setBalance(0);
+        } else {
+            bool shrank;
+            subtree = rebalance(parent, balance, shrank);
+            if(!shrank){ return; }
+        }
+        //subtree got one shorter, tell its parent
+        parent = subtree->getParent();
+        leftShrank = parent != NULL && parent->getLeft() == subtree;
+    }
+}
+
+/**
+ * rebalances the tree by finding zig-zigs, and zig-zags, and using left and right rotate
+ * GIVEN - curr is the node that is unbalanced, balance is its balance factor (2 or -2)
+ * The balance factors of the rotated nodes follow from the case, no heights are needed
+ * Returns the new root of the subtree. shrank is set if the subtree is now one shorter than
+ * before the change that unbalanced it (always the case after an insert)
+ * */
+template<class Key, class Value, class Alloc>
+AVLNode<Key, Value>* AVLTree<Key, Value, Alloc>::rebalance(AVLNode<Key, Value>* curr, int balance, bool& shrank){
+    shrank = true;
+    //zig right
+    if(balance == 2){
+        AVLNode<Key, Value>* rc = curr->getRight();
+        //zig right zag left
+        if(rc->getBalance() == -1){
+            AVLNode<Key, Value>* grandchild = rc->getLeft();
+            int gb = grandchild->getBalance();
+            rightRotate(rc);
+            leftRotate(curr);
+            curr->setBalance(gb == 1 ? -1 : 0);
+            rc->setBalance(gb == -1 ? 1 : 0);
+            grandchild->setBalance(0);
+            return grandchild;
+        }
+        //zig right zig right
+        leftRotate(curr);
+        if(rc->getBalance() == 0){
+            //only happens on remove: the subtree keeps its height
+            curr->setBalance(1);
+            rc->setBalance(-1);
+            shrank = false;
+        } else {
+            curr->setBalance(0);
+            rc->setBalance(0);
+        }
+        return rc;
+    }
+    //zig left
+    AVLNode<Key, Value>* lc = curr->getLeft();
+    //zig left zag right
+    if(lc->getBalance() == 1){
+        AVLNode<Key, Value>* grandchild = lc->getRight();
+        int gb = grandchild->getBalance();
+        leftRotate(lc);
+        rightRotate(curr);
+        curr->setBalance(gb == -1 ? 1 : 0);
+        lc->setBalance(gb == 1 ? -1 : 0);
+        grandchild->setBalance(0);
+        return grandchild;
+    }
+    //zig left zig left
+    rightRotate(curr);
+    if(lc->getBalance() == 0){
+        curr->setBalance(-1);
+        lc->setBalance(1);
+        shrank = false;
+    } else {
+        curr->setBalance(0);
+        lc->setBalance(0);
+    }
+    return lc;
+}
+
+/**
+ * This function does the right rotate on the node given
+ * Only the links change, the caller fixes the balance factors
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::rightRotate(AVLNode<Key, Value>* curr){
+    //case wherre right rotate cannot be done
+    if(curr->getLeft() == NULL){
+        return;
+    }
+    if(DEBUG){ std::cout << "Doing right rotate now on: " << curr->getKey() <<  std::endl;}
+    AVLNode<Key, Value>* lc = curr->getLeft();
+    AVLNode<Key, Value>* parent = curr->getParent();
+    //parent reroute
+    lc->setParent(parent);
+    if(parent == NULL){
+        BST::root_ = lc;
+    } else if(parent->getLeft() == curr){
+        parent->setLeft(lc);
+    } else {
+        parent->setRight(lc);
+    }
+    //curr adopts lc's rc
+    curr->setLeft(lc->getRight());
+    if(lc->getRight() != NULL){
+        lc->getRight()->setParent(curr);
+    }
+    //lc becomes curr's parent
+    lc->setRight(curr);
+    curr->setParent(lc);
+    //lc's subtree now has all of curr's nodes, curr lost lc and lc's lc
+    lc->setSize(curr->getSize());
+    curr->setSize(AVLNode<Key, Value>::sizeOf(curr->getLeft()) + AVLNode<Key, Value>::sizeOf(curr->getRight()) + 1);
+    if(DEBUG){
+        std::cout << "printing tree now after right rotate: " << std::endl;
+        BST::print();
+    }
+}
+
+/**
+ * This function does the left rotate on the node given
+ * Only the links change, the caller fixes the balance factors
+ * */
+template<class Key, class Value, class Alloc>
+void AVLTree<Key, Value, Alloc>::leftRotate(AVLNode<Key, Value>* curr){
+    //case wherre left rotate cannot be done
+    if(curr->getRight() == NULL){
+        return;
+    }
+    if(DEBUG){ std::cout << "Doing left rotate now on: " << curr->getKey() << std::endl;}
+    AVLNode<Key, Value>* rc = curr->getRight();
+    AVLNode<Key, Value>* parent = curr->getParent();
+    //parent reroute
+    rc->setParent(parent);
+    if(parent == NULL){
+        BST::root_ = rc;
+    } else if(parent->getLeft() == curr){
+        parent->setLeft(rc);
+    } else {
+        parent->setRight(rc);
+    }
+    //adopt rc's lc
+    curr->setRight(rc->getLeft());
+    if(rc->getLeft() != NULL){
+        rc->getLeft()->setParent(curr);
+    }
+    //rc becomes curr's parent
+    rc->setLeft(curr);
+    curr->setParent(rc);
+    rc->setSize(curr->getSize());
+    curr->setSize(AVLNode<Key, Value>::sizeOf(curr->getLeft()) + AVLNode<Key, Value>::sizeOf(curr->getRight()) + 1);
+    if(DEBUG){
+        std::cout << "printing tree now after left rotate: " << std::endl;
+        BST::print();
+    }
+
+}
+
+#endif
@@ -0,0 +1,659 @@
+#include "avlbst.h"
+#include "concurrentavl.h"
+#include "persistentavl.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <shared_mutex>
+
+using namespace std;
+
+/**
+ * Every result is one row of a single CSV table, so runs from different commits can be diffed
+ * */
+class CsvReport{
+    public:
+        CsvReport(ostream& out) : out(out){
+            out << "suite,structure,n,op,ns_per_op" << endl;
+        }
+        void row(const string& suite, const string& structure, long long n, const string& op, double nsPerOp){
+            out << suite << "," << structure << "," << n << "," << op << "," << nsPerOp << endl;
+        }
+    private:
+        ostream& out;
+};
+
+double nsSince(chrono::steady_clock::time_point start){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+//n distinct keys in random order
+vector<int> makeKeys(int n){
+    vector<int> keys(n);
+    for(int i = 0 ; i < n ; i++){
+        keys[i] = i * 2;
+    }
+    mt19937 rng(104 + n);
+    shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+//the trees remove by key, std::map erases by key
+template<class Tree>
+void removeKey(Tree& tree, int key){
+    tree.remove(key);
+}
+
+void removeKey(map<int, int>& tree, int key){
+    tree.erase(key);
+}
+
+/**
+ * Random inserts, then finds of present and absent keys in another random order, a full in-order scan,
+ * and removing every key in the find order
+ * Tree is AVLTree, BinarySearchTree or std::map, all have insert(pair)/find/end/begin
+ * */
+template<class Tree>
+void lookupRun(CsvReport& report, const string& structure, int n){
+    vector<int> keys = makeKeys(n);
+    vector<int> probes = makeKeys(n);
+    Tree tree;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(keys[i], i));
+    }
+    report.row("lookup", structure, n, "insert", nsSince(start) / n);
+
+    long long found = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.find(probes[i]) != tree.end()){ found++; }
+    }
+    report.row("lookup", structure, n, "find_hit", nsSince(start) / n);
+
+    //odd keys are never inserted
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.find(probes[i] + 1) != tree.end()){ found++; }
+    }
+    report.row("lookup", structure, n, "find_miss", nsSince(start) / n);
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for(typename Tree::iterator it = tree.begin() ; it != tree.end() ; ++it){
+        sum += it->second;
+    }
+    report.row("lookup", structure, n, "iterate", nsSince(start) / n);
+    if(found != n || sum != (long long)n * (n-1) / 2){
+        cerr << "ERROR: " << structure << " lost items" << endl;
+    }
+
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        removeKey(tree, probes[i]);
+    }
+    report.row("lookup", structure, n, "remove", nsSince(start) / n);
+    if(tree.begin() != tree.end()){
+        cerr << "ERROR: " << structure << " is not empty after removing everything" << endl;
+    }
+}
+
+//string keys that don't fit in the small string buffer, so every node owns heap memory
+string makeStringKey(int key){
+    return "destroy_bench_key_" + to_string(key);
+}
+
+/**
+ * Builds a tree of n random keys and times only its destruction
+ * */
+template<class Tree, class K>
+void destroyRun(CsvReport& report, const string& structure, int n, K (*makeKey)(int)){
+    vector<int> keys = makeKeys(n);
+    Tree* tree = new Tree();
+    for(int i = 0 ; i < n ; i++){
+        tree->insert(make_pair(makeKey(keys[i]), i));
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    delete tree;
+    report.row("destroy", structure, n, "destroy", nsSince(start) / n);
+}
+
+/**
+ * Startup from a sorted dump: n inserts in key order against the bulk loads, and std::map
+ * inserting at end(). sort_and_build starts from the shuffled keys
+ * */
+void buildRun(CsvReport& report, int n){
+    vector<pair<int, int> > sorted(n);
+    for(int i = 0 ; i < n ; i++){
+        sorted[i] = make_pair(i * 2, i);
+    }
+    vector<int> keys = makeKeys(n);
+    vector<pair<int, int> > shuffled(n);
+    for(int i = 0 ; i < n ; i++){
+        shuffled[i] = make_pair(keys[i], keys[i] / 2);
+    }
+    long long sum = 0;
+
+    AVLTree<int, int> inserted;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        inserted.insert(sorted[i]);
+    }
+    report.row("build", "avl", n, "sorted_insert", nsSince(start) / n);
+
+    AVLTree<int, int> built;
+    start = chrono::steady_clock::now();
+    built.buildFromSorted(sorted.begin(), sorted.end());
+    report.row("build", "avl", n, "build_from_sorted", nsSince(start) / n);
+
+    AVLTree<int, int> sortBuilt;
+    start = chrono::steady_clock::now();
+    sortBuilt.sortAndBuild(shuffled.begin(), shuffled.end());
+    report.row("build", "avl", n, "sort_and_build", nsSince(start) / n);
+
+    map<int, int> hinted;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        hinted.insert(hinted.end(), sorted[i]);
+    }
+    report.row("build", "std_map", n, "sorted_insert", nsSince(start) / n);
+
+    AVLTree<int, int>* trees[] = {&inserted, &built, &sortBuilt};
+    for(int t = 0 ; t < 3 ; t++){
+        for(AVLTree<int, int>::iterator it = trees[t]->begin() ; it != trees[t]->end() ; ++it){
+            sum += it->second;
+        }
+    }
+    if(sum != 3 * ((long long)n * (n-1) / 2) || hinted.size() != (size_t)n){
+        cerr << "ERROR: a built tree lost items" << endl;
+    }
+}
+
+/**
+ * Order statistics on a tree of n random keys: rank of present keys, select of random positions
+ * and counting the keys of short ranges
+ * */
+void orderRun(CsvReport& report, int n){
+    vector<int> keys = makeKeys(n);
+    vector<int> probes = makeKeys(n);
+    AVLTree<int, int> tree;
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(keys[i], i));
+    }
+
+    //every key is even, so key k has rank k/2
+    long long wrong = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.rank(probes[i]) != (size_t)probes[i] / 2){ wrong++; }
+    }
+    report.row("order", "avl", n, "rank", nsSince(start) / n);
+
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.select(probes[i] / 2)->first != probes[i]){ wrong++; }
+    }
+    report.row("order", "avl", n, "select", nsSince(start) / n);
+
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.countRange(probes[i], probes[i] + 100) != (size_t)min(50, n - probes[i] / 2)){ wrong++; }
+    }
+    report.row("order", "avl", n, "count_range", nsSince(start) / n);
+    if(wrong != 0){
+        cerr << "ERROR: " << wrong << " wrong order statistics" << endl;
+    }
+}
+
+/**
+ * Time-window queries: summing the values of the 50 keys in [key, key + 100) for random keys,
+ * with forEachInRange, and with lower_bound and an iterator on std::map
+ * */
+void rangeRun(CsvReport& report, int n){
+    vector<int> keys = makeKeys(n);
+    vector<int> probes = makeKeys(n);
+    AVLTree<int, int> tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(keys[i], i));
+        expected.insert(make_pair(keys[i], i));
+    }
+
+    long long treeSum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        tree.forEachInRange(probes[i], probes[i] + 100, [&treeSum](pair<const int, int>& item){ treeSum += item.second; });
+    }
+    report.row("range", "avl", n, "window_50", nsSince(start) / n);
+
+    long long mapSum = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        for(map<int, int>::iterator it = expected.lower_bound(probes[i]) ; it != expected.end() && it->first < probes[i] + 100 ; ++it){
+            mapSum += it->second;
+        }
+    }
+    report.row("range", "std_map", n, "window_50", nsSince(start) / n);
+    if(treeSum != mapSum){
+        cerr << "ERROR: range sums differ" << endl;
+    }
+}
+
+/**
+ * Word counting like Hashtable's AVL mode: n increments spread over n/10 string keys,
+ * once as find + insert (what add() used to do) and once with upsert
+ * */
+void upsertRun(CsvReport& report, int n){
+    vector<int> keys = makeKeys(n);
+    vector<string> words(n);
+    for(int i = 0 ; i < n ; i++){
+        words[i] = makeStringKey(keys[i] % (n / 10 + 1));
+    }
+
+    AVLTree<string, int> counted;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        AVLTree<string, int>::iterator it = counted.find(words[i]);
+        int count = it == counted.end() ? 0 : it->second;
+        counted.insert(make_pair(words[i], count + 1));
+    }
+    report.row("upsert", "avl_string", n, "find_insert", nsSince(start) / n);
+
+    AVLTree<string, int> upserted;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        upserted.upsert(words[i], [](int& count){ count++; });
+    }
+    report.row("upsert", "avl_string", n, "upsert", nsSince(start) / n);
+
+    map<string, int> expected;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        expected[words[i]]++;
+    }
+    report.row("upsert", "std_map_string", n, "operator[]", nsSince(start) / n);
+    if(counted.size() != expected.size() || upserted.size() != expected.size()){
+        cerr << "ERROR: word counts differ" << endl;
+    }
+}
+
+/**
+ * Time-ordered ingestion: keys in increasing order, and nearly in order (every key is
+ * swapped with one of the next few), inserted plainly and with end() as the hint
+ * */
+void appendRun(CsvReport& report, int n){
+    vector<int> sorted(n);
+    for(int i = 0 ; i < n ; i++){
+        sorted[i] = i;
+    }
+    vector<int> nearly = sorted;
+    mt19937 rng(7 + n);
+    for(int i = 0 ; i + 4 < n ; i++){
+        swap(nearly[i], nearly[i + rng() % 4]);
+    }
+    vector<int>* orders[] = {&sorted, &nearly};
+    string names[] = {"sorted", "nearly_sorted"};
+    for(int o = 0 ; o < 2 ; o++){
+        vector<int>& keys = *orders[o];
+        AVLTree<int, int> plain;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for(int i = 0 ; i < n ; i++){
+            plain.insert(make_pair(keys[i], i));
+        }
+        report.row("append", "avl", n, names[o] + "_insert", nsSince(start) / n);
+
+        AVLTree<int, int> hinted;
+        start = chrono::steady_clock::now();
+        for(int i = 0 ; i < n ; i++){
+            hinted.insert(hinted.end(), make_pair(keys[i], i));
+        }
+        report.row("append", "avl", n, names[o] + "_hinted", nsSince(start) / n);
+
+        map<int, int> expected;
+        start = chrono::steady_clock::now();
+        for(int i = 0 ; i < n ; i++){
+            expected.insert(expected.end(), make_pair(keys[i], i));
+        }
+        report.row("append", "std_map", n, names[o] + "_hinted", nsSince(start) / n);
+        if(plain.size() != (size_t)n || hinted.size() != (size_t)n){
+            cerr << "ERROR: appended trees lost items" << endl;
+        }
+    }
+}
+
+/**
+ * Tree of the given keys (repeats are fine), built with a bulk load outside the timed part
+ * */
+void buildTree(AVLTree<int, int>& tree, const vector<int>& keys){
+    vector<pair<int, int> > items;
+    for(size_t i = 0 ; i < keys.size() ; i++){
+        items.push_back(make_pair(keys[i], (int)i));
+    }
+    tree.sortAndBuild(items.begin(), items.end());
+}
+
+/**
+ * Combining a tree of n keys with one of m keys (m = n, and m = n / 100), half of them shared:
+ * unionWith, intersectWith and subtract against doing the same one key at a time
+ * reports the time per item of the two trees together
+ * */
+void setopsRun(CsvReport& report, int n){
+    for(int shape = 0 ; shape < 2 ; shape++){
+        int m = shape == 0 ? n : max(1, n / 100);
+        string name = shape == 0 ? "_equal" : "_small";
+        //a has the even keys up to 2n, b has m keys of which half are in a
+        vector<int> aKeys = makeKeys(n);
+        vector<int> bKeys;
+        mt19937 rng(11 + n);
+        for(int i = 0 ; i < m ; i++){
+            bKeys.push_back(i % 2 == 0 ? 2 * (rng() % n) : 2 * (rng() % n) + 1);
+        }
+        AVLTree<int, int> b;
+        buildTree(b, bKeys);
+        //b may have fewer keys than m after duplicates, the counts below use its size
+        double items = n + b.size();
+
+        AVLTree<int, int> a;
+        buildTree(a, aKeys);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        a.unionWith(b);
+        report.row("setops", "avl", n, "union" + name, nsSince(start) / items);
+        size_t unionSize = a.size();
+
+        buildTree(a, aKeys);
+        start = chrono::steady_clock::now();
+        for(AVLTree<int, int>::iterator it = b.begin() ; it != b.end() ; ++it){
+            a.try_emplace(it->first, it->second);
+        }
+        report.row("setops", "avl_one_by_one", n, "union" + name, nsSince(start) / items);
+        if(a.size() != unionSize){
+            cerr << "ERROR: unionWith and inserting one by one disagree" << endl;
+        }
+
+        buildTree(a, aKeys);
+        start = chrono::steady_clock::now();
+        a.intersectWith(b);
+        report.row("setops", "avl", n, "intersect" + name, nsSince(start) / items);
+        size_t intersectSize = a.size();
+
+        buildTree(a, aKeys);
+        start = chrono::steady_clock::now();
+        vector<int> missing;
+        for(AVLTree<int, int>::iterator it = a.begin() ; it != a.end() ; ++it){
+            if(b.find(it->first) == b.end()){
+                missing.push_back(it->first);
+            }
+        }
+        for(size_t i = 0 ; i < missing.size() ; i++){
+            a.remove(missing[i]);
+        }
+        report.row("setops", "avl_one_by_one", n, "intersect" + name, nsSince(start) / items);
+        if(a.size() != intersectSize){
+            cerr << "ERROR: intersectWith and removing one by one disagree" << endl;
+        }
+
+        buildTree(a, aKeys);
+        start = chrono::steady_clock::now();
+        a.subtract(b);
+        report.row("setops", "avl", n, "subtract" + name, nsSince(start) / items);
+        size_t subtractSize = a.size();
+
+        buildTree(a, aKeys);
+        start = chrono::steady_clock::now();
+        for(AVLTree<int, int>::iterator it = b.begin() ; it != b.end() ; ++it){
+            a.remove(it->first);
+        }
+        report.row("setops", "avl_one_by_one", n, "subtract" + name, nsSince(start) / items);
+        if(a.size() != subtractSize){
+            cerr << "ERROR: subtract and removing one by one disagree" << endl;
+        }
+    }
+}
+
+/**
+ * Point-in-time views: updates on PersistentAVLTree (path copying) against AVLTree, and a
+ * snapshot of n items taken in O(1) against copying the AVLTree with a bulk load
+ * */
+void snapshotRun(CsvReport& report, int n){
+    vector<int> keys = makeKeys(n);
+    PersistentAVLTree<int, int> persistent;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        persistent.insert(make_pair(keys[i], i));
+    }
+    report.row("snapshot", "persistent_avl", n, "insert", nsSince(start) / n);
+
+    AVLTree<int, int> tree;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(keys[i], i));
+    }
+    report.row("snapshot", "avl", n, "insert", nsSince(start) / n);
+
+    long long hits = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        hits += persistent.contains(keys[i]);
+    }
+    report.row("snapshot", "persistent_avl", n, "find_hit", nsSince(start) / n);
+
+    const int snapshots = 100;
+    vector<PersistentAVLTree<int, int> > views;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < snapshots ; i++){
+        views.push_back(persistent.snapshot());
+    }
+    report.row("snapshot", "persistent_avl", n, "snapshot", nsSince(start) / snapshots);
+
+    int copies = n >= 100000 ? 3 : snapshots;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < copies ; i++){
+        vector<pair<int, int> > items;
+        items.reserve(n);
+        for(AVLTree<int, int>::iterator it = tree.begin() ; it != tree.end() ; ++it){
+            items.push_back(make_pair(it->first, it->second));
+        }
+        AVLTree<int, int> copy;
+        copy.buildFromSorted(items.begin(), items.end());
+        hits += copy.size() == (size_t)n;
+    }
+    report.row("snapshot", "avl", n, "snapshot", nsSince(start) / copies);
+
+    //updates while snapshots hold on to the old versions
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        persistent.remove(keys[i]);
+    }
+    report.row("snapshot", "persistent_avl", n, "remove", nsSince(start) / n);
+    if(hits != n + copies || views.back().size() != (size_t)n || !persistent.empty()){
+        cerr << "ERROR: persistent_avl lost items" << endl;
+    }
+}
+
+/**
+ * AVLTree behind a readers-writer lock, the obvious way to share a tree between threads
+ * */
+class LockedAVL
+{
+    public:
+        bool find(int key, int& value) const {
+            shared_lock<shared_mutex> lock(mutex_);
+            AVLTree<int, int>::iterator it = tree_.find(key);
+            if(it == tree_.end()){
+                return false;
+            }
+            value = it->second;
+            return true;
+        }
+        void insert(const pair<const int, int>& keyValuePair){
+            unique_lock<shared_mutex> lock(mutex_);
+            tree_.insert(keyValuePair);
+        }
+        void remove(int key){
+            unique_lock<shared_mutex> lock(mutex_);
+            tree_.remove(key);
+        }
+    private:
+        mutable shared_mutex mutex_;
+        mutable AVLTree<int, int> tree_;
+};
+
+/**
+ * Read-mostly sharing: each of the reader threads look up random keys while one writer keeps
+ * inserting and removing other keys; reports the wall time per lookup over all readers
+ * */
+template<class Tree>
+void concurrentRun(CsvReport& report, const string& structure, int n, int readers){
+    const int lookups = 200000;
+    Tree tree;
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(2 * i, i));
+    }
+    atomic<bool> done(false);
+    atomic<long long> found(0);
+    thread writer([&tree, &done, n](){
+        mt19937 rng(n);
+        while(!done.load(memory_order_relaxed)){
+            int key = 2 * (rng() % n) + 1;
+            if(rng() % 2 == 0){
+                tree.insert(make_pair(key, key));
+            } else {
+                tree.remove(key);
+            }
+        }
+    });
+    vector<thread> threads;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int t = 0 ; t < readers ; t++){
+        threads.push_back(thread([&tree, &found, n, t](){
+            mt19937 rng(t);
+            long long hits = 0;
+            int value;
+            for(int i = 0 ; i < lookups ; i++){
+                hits += tree.find(2 * (rng() % n), value);
+            }
+            found += hits;
+        }));
+    }
+    for(int t = 0 ; t < readers ; t++){
+        threads[t].join();
+    }
+    double elapsed = nsSince(start);
+    done = true;
+    writer.join();
+    report.row("concurrent", structure, n, "find_" + to_string(readers) + "_readers", elapsed / ((double)lookups * readers));
+    if(found != (long long)lookups * readers){
+        cerr << "ERROR: " << structure << " missed keys that were never removed" << endl;
+    }
+}
+
+int intKey(int key){
+    return key;
+}
+
+void usage(){
+    cerr << "usage: ./bench [--suite all|lookup|destroy|build|order|range|upsert|append|concurrent|snapshot|setops] [--min-size N] [--max-size N] [--csv FILE]" << endl
+         << "sizes go from --min-size to --max-size by factors of 10 (default 1000 to 1000000)" << endl;
+}
+
+/**
+ * AVLTree benchmarks, written as one CSV table to stdout (or --csv FILE)
+ * lookup: insert, find, in-order iteration and remove of AVLTree against std::map
+ * (and the unbalanced BinarySearchTree, which stays shallow enough with random keys)
+ * destroy: time to destroy a whole tree, with the pool and with std::allocator, int and string keys
+ * build: building a tree from sorted items, one insert at a time and with the bulk loads
+ * order: rank, select and countRange
+ * range: short range scans
+ * upsert: counting words with find + insert against upsert
+ * append: inserting keys in (nearly) increasing order, with and without a hint
+ * concurrent: lookups from 1 to 8 threads next to one writer, lock-free readers against a shared_mutex
+ * snapshot: PersistentAVLTree updates and O(1) snapshots against copying an AVLTree
+ * setops: union, intersection and difference of two trees against one key at a time
+ * */
+int main(int argc, char* argv[]){
+    string suite = "all";
+    long long minSize = 1000;
+    long long maxSize = 1000000;
+    string csvFile = "";
+    for(int i = 1 ; i < argc ; i += 2){
+        string arg = argv[i];
+        if(i+1 >= argc){
+            usage();
+            return 1;
+        }
+        if(arg == "--suite"){
+            suite = argv[i+1];
+        } else if(arg == "--min-size"){
+            minSize = atoll(argv[i+1]);
+        } else if(arg == "--max-size"){
+            maxSize = atoll(argv[i+1]);
+        } else if(arg == "--csv"){
+            csvFile = argv[i+1];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if(minSize < 1){ minSize = 1; }
+
+    ofstream file;
+    if(csvFile != ""){
+        file.open(csvFile.c_str());
+        if(!file){
+            cerr << "Could not open " << csvFile << endl;
+            return 1;
+        }
+    }
+    CsvReport report(csvFile != "" ? (ostream&)file : cout);
+
+    for(long long n = minSize ; n <= maxSize ; n *= 10){
+        if(suite == "all" || suite == "lookup"){
+            lookupRun<AVLTree<int, int> >(report, "avl", n);
+            lookupRun<BinarySearchTree<int, int> >(report, "bst", n);
+            lookupRun<map<int, int> >(report, "std_map", n);
+        }
+        if(suite == "all" || suite == "destroy"){
+            destroyRun<AVLTree<int, int>, int>(report, "avl", n, intKey);
+            destroyRun<AVLTree<int, int, allocator<pair<const int, int> > >, int>(report, "avl_std_allocator", n, intKey);
+            destroyRun<map<int, int>, int>(report, "std_map", n, intKey);
+            destroyRun<AVLTree<string, int>, string>(report, "avl_string", n, makeStringKey);
+            destroyRun<map<string, int>, string>(report, "std_map_string", n, makeStringKey);
+        }
+        if(suite == "all" || suite == "build"){
+            buildRun(report, n);
+        }
+        if(suite == "all" || suite == "order"){
+            orderRun(report, n);
+        }
+        if(suite == "all" || suite == "range"){
+            rangeRun(report, n);
+        }
+        if(suite == "all" || suite == "upsert"){
+            upsertRun(report, n);
+        }
+        if(suite == "all" || suite == "append"){
+            appendRun(report, n);
+        }
+        if(suite == "all" || suite == "concurrent"){
+            for(int readers = 1 ; readers <= 8 ; readers *= 2){
+                concurrentRun<ConcurrentAVLTree<int, int> >(report, "concurrent_avl", n, readers);
+                concurrentRun<LockedAVL>(report, "avl_shared_mutex", n, readers);
+            }
+        }
+        if(suite == "all" || suite == "snapshot"){
+            snapshotRun(report, n);
+        }
+        if(suite == "all" || suite == "setops"){
+            setopsRun(report, n);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "concurrentavl.h"
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+const int STABLE = 2000;
+const int WRITES = 200000;
+const int READERS = 4;
+
+/**
+ * One writer changes the tree while readers look keys up without locks.
+ * Even keys are inserted up front and never removed (the writer only replaces them with the same
+ * value), so readers must always find them, even while rotations and removes move nodes around
+ * them. Odd keys come and go, and when found must have a value that belongs to them.
+ * returns the number of failed checks
+ * */
+int stressTest(){
+    ConcurrentAVLTree<int, int> tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < STABLE ; i++){
+        tree.insert(make_pair(2 * i, 20 * i));
+        expected[2 * i] = 20 * i;
+    }
+    atomic<bool> done(false);
+    atomic<int> failed(0);
+    atomic<long long> reads(0);
+    vector<thread> readers;
+    for(int t = 0 ; t < READERS ; t++){
+        readers.push_back(thread([&tree, &done, &failed, &reads, t](){
+            mt19937 rng(t);
+            long long count = 0;
+            while(!done.load()){
+                int key = rng() % (2 * STABLE);
+                int value;
+                bool found = tree.find(key, value);
+                if(key % 2 == 0 && (!found || value != 10 * key)){ failed++; }
+                if(key % 2 == 1 && found && value / 10 != key){ failed++; }
+                count++;
+            }
+            reads += count;
+        }));
+    }
+
+    mt19937 rng(99);
+    for(int i = 0 ; i < WRITES ; i++){
+        int key = rng() % (2 * STABLE);
+        if(key % 2 == 0){
+            tree.insert(make_pair(key, 10 * key));
+        } else if(rng() % 2 == 0){
+            int value = 10 * key + (int)(rng() % 10);
+            tree.insert(make_pair(key, value));
+            expected[key] = value;
+        } else {
+            tree.remove(key);
+            expected.erase(key);
+        }
+        //let the readers run now and then on a single core
+        if(i % 1000 == 0){ this_thread::yield(); }
+    }
+    done = true;
+    for(int t = 0 ; t < READERS ; t++){
+        readers[t].join();
+    }
+
+    int wrong = failed.load();
+    if(!tree.isBalanced() || tree.size() != expected.size()){ wrong++; }
+    map<int, int>::iterator it = expected.begin();
+    tree.forEach([&it, &expected, &wrong](const int& key, const int& value){
+        if(it == expected.end() || it->first != key || it->second != value){ wrong++; }
+        else { ++it; }
+    });
+    if(it != expected.end()){ wrong++; }
+    cout << reads.load() << " lock-free reads during " << WRITES << " writes" << endl;
+    return wrong;
+}
+
+int main(){
+    if(stressTest() != 0){
+        cout << "FAILED: concurrent stress test" << endl;
+        return 1;
+    }
+    cout << "concurrent stress test passed" << endl;
+    return 0;
+}
@@ -0,0 +1,616 @@
+#ifndef CONCURRENTAVL_H
+#define CONCURRENTAVL_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+//reader counters are spread over this many cache lines, threads pick one by their id
+const int CONCURRENT_AVL_READER_SLOTS = 64;
+//removed nodes are freed once this many are waiting
+const std::size_t CONCURRENT_AVL_RECLAIM_BATCH = 256;
+
+/**
+ * A node of ConcurrentAVLTree. The key and value never change once the node is in the tree
+ * (a new value replaces the whole node), so readers can use them without any locking.
+ * Only the child links are read by readers, and every change to them that could hide a key
+ * from a reader standing on the node bumps the version:
+ * odd while the node's links change, and odd forever once the node is taken out of the tree.
+ * parent and height are only used by the writer.
+ */
+template <typename Key, typename Value>
+struct ConcurrentAVLNode
+{
+    ConcurrentAVLNode(const Key& key, const Value& value, ConcurrentAVLNode<Key, Value>* parent);
+
+    const Key key;
+    const Value value;
+    std::atomic<std::uint64_t> version;
+    std::atomic<ConcurrentAVLNode<Key, Value>*> left;
+    std::atomic<ConcurrentAVLNode<Key, Value>*> right;
+    ConcurrentAVLNode<Key, Value>* parent;
+    int height;
+};
+
+/**
+ * An AVL tree for many readers and few writers.
+ *
+ * Readers (find, contains) take no lock and write nothing shared but one striped counter.
+ * They walk down optimistically, like Bronson et al.'s concurrent AVL tree: at every step they
+ * read the child link and the child's version and then check that the parent's version didn't
+ * change, so the child really was the parent's child with the key range they expect. If it
+ * did change (a rotation or remove moved keys out from under them) the walk starts over at the
+ * root, which is rare since writes only touch O(log n) nodes.
+ *
+ * Writers (insert, remove) are serialized by one mutex, so they need no per-node locks. A
+ * rotation or remove marks the nodes whose subtrees lose keys (odd version) before relinking
+ * and unmarks them after. Removed and replaced nodes are not freed right away, a reader may still
+ * be standing on them: they wait in a list until every reader that could have seen them is done.
+ * Readers announce themselves in a counter for the current epoch (of two), and the writer flips
+ * the epoch and waits for the old epoch's counters to drain before freeing, like userspace RCU.
+ */
+template <typename Key, typename Value>
+class ConcurrentAVLTree
+{
+public:
+    typedef ConcurrentAVLNode<Key, Value> Node;
+
+    ConcurrentAVLTree();
+    //no thread may use the tree any more
+    ~ConcurrentAVLTree();
+
+    // Readers, safe to call from any number of threads at once, also while writers run
+    //copies the value of key into value and returns true, or returns false if key is missing
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+
+    // Writers, serialized among themselves
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    std::size_t size() const;
+    //calls fn(key, value) on every item in key order, no writer runs in the meantime
+    template<class Fn>
+    void forEach(Fn fn) const;
+    //checks heights, balance, order and parent links, no writer runs in the meantime
+    bool isBalanced() const;
+
+private:
+    //what one optimistic walk down found
+    enum Outcome { FOUND, MISSING, RETRY };
+    Outcome attemptFind(const Key& key, Value* value) const;
+
+    //announces a reader for its lifetime, so nothing it can reach is freed
+    class ReadGuard
+    {
+    public:
+        ReadGuard(const ConcurrentAVLTree<Key, Value>& tree);
+        ~ReadGuard();
+    private:
+        const ConcurrentAVLTree<Key, Value>& tree_;
+        int slot_;
+        std::uint64_t epoch_;
+    };
+
+    //the two reader counts of a slot, one per epoch parity, on a cache line of their own
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<long> count[2];
+    };
+
+    static int readerSlot();
+    static int height(const Node* node);
+    static void beginChange(Node* node);
+    static void endChange(Node* node);
+    //parent's link to child, or the root link if parent is NULL
+    std::atomic<Node*>& linkTo(Node* parent, Node* child);
+    //puts replacement where node is, node keeps its links (readers may still follow them)
+    void replace(Node* node, Node* replacement);
+    void rotateLeft(Node* node);
+    void rotateRight(Node* node);
+    //fixes heights and rotates from node up to the root
+    void rebalanceFrom(Node* node);
+    //takes node out for good: its version stays odd, and it is freed after the readers move on
+    void retire(Node* node);
+    //waits until no reader can reach a retired node and frees them all
+    void reclaim();
+    void freeSubtree(Node* node);
+    template<class Fn>
+    void forEachIn(Node* node, Fn& fn) const;
+    int checkSubtree(Node* node, Node* parent) const;
+
+    std::atomic<Node*> root_;
+    std::size_t size_;
+    mutable std::mutex writeLock_;
+    std::vector<Node*> retired_;
+    std::atomic<std::uint64_t> epoch_;
+    mutable ReaderSlot readers_[CONCURRENT_AVL_READER_SLOTS];
+};
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for ConcurrentAVLNode.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+ConcurrentAVLNode<Key, Value>::ConcurrentAVLNode(const Key& key, const Value& value, ConcurrentAVLNode<Key, Value>* parent) :
+    key(key),
+    value(value),
+    version(0),
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    height(1)
+{
+
+}
+
+/*
+  -------------------------------------------------
+  End implementations for ConcurrentAVLNode.
+  -------------------------------------------------
+*/
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for ConcurrentAVLTree.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::ConcurrentAVLTree() :
+    root_(NULL),
+    size_(0),
+    epoch_(0)
+{
+    for(int i = 0 ; i < CONCURRENT_AVL_READER_SLOTS ; i++){
+        readers_[i].count[0].store(0);
+        readers_[i].count[1].store(0);
+    }
+}
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::~ConcurrentAVLTree()
+{
+    freeSubtree(root_.load());
+    for(std::size_t i = 0 ; i < retired_.size() ; i++){
+        delete retired_[i];
+    }
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::freeSubtree(Node* node)
+{
+    if(node == NULL){
+        return;
+    }
+    freeSubtree(node->left.load());
+    freeSubtree(node->right.load());
+    delete node;
+}
+
+/**
+ * Every thread keeps the slot its id hashes to
+ */
+template<class Key, class Value>
+int ConcurrentAVLTree<Key, Value>::readerSlot()
+{
+    static thread_local int slot = std::hash<std::thread::id>()(std::this_thread::get_id()) % CONCURRENT_AVL_READER_SLOTS;
+    return slot;
+}
+
+/**
+ * Counts the reader in the current epoch. If a writer flipped the epoch in between, the reader
+ * may have been missed by its wait, so it moves to the new epoch, which that writer doesn't free
+ */
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::ReadGuard::ReadGuard(const ConcurrentAVLTree<Key, Value>& tree) :
+    tree_(tree),
+    slot_(readerSlot())
+{
+    while(true){
+        epoch_ = tree_.epoch_.load();
+        tree_.readers_[slot_].count[epoch_ & 1].fetch_add(1);
+        if(tree_.epoch_.load() == epoch_){
+            return;
+        }
+        tree_.readers_[slot_].count[epoch_ & 1].fetch_sub(1);
+    }
+}
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::ReadGuard::~ReadGuard()
+{
+    tree_.readers_[slot_].count[epoch_ & 1].fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * Retries the optimistic walk until it gets through without a writer getting in the way
+ * runtime = O(log n) per walk
+ */
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::find(const Key& key, Value& value) const
+{
+    ReadGuard guard(*this);
+    Outcome outcome;
+    do{
+        outcome = attemptFind(key, &value);
+    } while(outcome == RETRY);
+    return outcome == FOUND;
+}
+
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::contains(const Key& key) const
+{
+    ReadGuard guard(*this);
+    Outcome outcome;
+    do{
+        outcome = attemptFind(key, NULL);
+    } while(outcome == RETRY);
+    return outcome == FOUND;
+}
+
+/**
+ * One walk down from the root. version is the version of node when the walk got to it; as long
+ * as it is unchanged, every key that could be in node's subtree when the walk got there still is
+ * A child is only taken if, after reading its version, it is still node's child and node is
+ * still unchanged. A node's key and value never change, so the item is read without checks
+ */
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Outcome ConcurrentAVLTree<Key, Value>::attemptFind(const Key& key, Value* value) const
+{
+    Node* node = root_.load(std::memory_order_acquire);
+    if(node == NULL){
+        return MISSING;
+    }
+    std::uint64_t version = node->version.load(std::memory_order_acquire);
+    if((version & 1) != 0 || root_.load(std::memory_order_acquire) != node){
+        return RETRY;
+    }
+    while(true){
+        bool goLeft = key < node->key;
+        if(!goLeft && !(node->key < key)){
+            if(value != NULL){
+                *value = node->value;
+            }
+            return FOUND;
+        }
+        const std::atomic<Node*>& link = goLeft ? node->left : node->right;
+        Node* child = link.load(std::memory_order_acquire);
+        if(child == NULL){
+            return node->version.load(std::memory_order_acquire) == version ? MISSING : RETRY;
+        }
+        std::uint64_t childVersion = child->version.load(std::memory_order_acquire);
+        if((childVersion & 1) != 0 || link.load(std::memory_order_acquire) != child
+            || node->version.load(std::memory_order_acquire) != version){
+            return RETRY;
+        }
+        node = child;
+        version = childVersion;
+    }
+}
+
+template<class Key, class Value>
+std::size_t ConcurrentAVLTree<Key, Value>::size() const
+{
+    std::lock_guard<std::mutex> lock(writeLock_);
+    return size_;
+}
+
+template<class Key, class Value>
+int ConcurrentAVLTree<Key, Value>::height(const Node* node)
+{
+    return node == NULL ? 0 : node->height;
+}
+
+/**
+ * Marks node as changing. The RMW keeps the relinking after it from being seen first
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::beginChange(Node* node)
+{
+    node->version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::endChange(Node* node)
+{
+    node->version.fetch_add(1, std::memory_order_release);
+}
+
+template<class Key, class Value>
+std::atomic<typename ConcurrentAVLTree<Key, Value>::Node*>& ConcurrentAVLTree<Key, Value>::linkTo(Node* parent, Node* child)
+{
+    if(parent == NULL){
+        return root_;
+    }
+    return parent->left.load(std::memory_order_relaxed) == child ? parent->left : parent->right;
+}
+
+/**
+ * replacement takes node's place: its parent, children and height. Readers on node will fail their
+ * next check, since node was marked by retire() first, and go around through replacement
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::replace(Node* node, Node* replacement)
+{
+    Node* left = node->left.load(std::memory_order_relaxed);
+    Node* right = node->right.load(std::memory_order_relaxed);
+    replacement->parent = node->parent;
+    replacement->height = node->height;
+    replacement->left.store(left, std::memory_order_relaxed);
+    replacement->right.store(right, std::memory_order_relaxed);
+    if(left != NULL){ left->parent = replacement; }
+    if(right != NULL){ right->parent = replacement; }
+    //publishes replacement along with its key, value and links
+    linkTo(node->parent, node).store(replacement, std::memory_order_release);
+}
+
+/**
+ * Inserts the item, or replaces the value of the key with a new node holding the new value
+ * runtime = O(log n), plus waiting for readers once every CONCURRENT_AVL_RECLAIM_BATCH removed nodes
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    std::lock_guard<std::mutex> lock(writeLock_);
+    const Key& key = keyValuePair.first;
+    Node* curr = root_.load(std::memory_order_relaxed);
+    Node* parent = NULL;
+    while(curr != NULL){
+        parent = curr;
+        if(key < curr->key){
+            curr = curr->left.load(std::memory_order_relaxed);
+        } else if(curr->key < key){
+            curr = curr->right.load(std::memory_order_relaxed);
+        } else {
+            //if equal, then a new node with the new value takes its place
+            Node* replacement = new Node(key, keyValuePair.second, NULL);
+            retire(curr);
+            replace(curr, replacement);
+            reclaim();
+            return;
+        }
+    }
+    //a new leaf only adds a key below parent, no reader can miss anything because of it
+    Node* leaf = new Node(key, keyValuePair.second, parent);
+    if(parent == NULL){
+        root_.store(leaf, std::memory_order_release);
+    } else if(key < parent->key){
+        parent->left.store(leaf, std::memory_order_release);
+    } else {
+        parent->right.store(leaf, std::memory_order_release);
+    }
+    size_++;
+    rebalanceFrom(parent);
+}
+
+/**
+ * Removes the key, if it is there.
+ * A node with at most one child is spliced out. A node with two children is replaced by a copy
+ * of its successor, and the successor is spliced out further down. That moves the successor's
+ * key up, out of the subtrees between the two, so those nodes are marked while it happens
+ * (a reader in them could otherwise walk past the key's new place and miss it)
+ * runtime = O(log n), plus waiting for readers once every CONCURRENT_AVL_RECLAIM_BATCH removed nodes
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::remove(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(writeLock_);
+    Node* node = root_.load(std::memory_order_relaxed);
+    while(node != NULL && (key < node->key || node->key < key)){
+        node = key < node->key ? node->left.load(std::memory_order_relaxed) : node->right.load(std::memory_order_relaxed);
+    }
+    if(node == NULL){
+        return;
+    }
+    Node* left = node->left.load(std::memory_order_relaxed);
+    Node* right = node->right.load(std::memory_order_relaxed);
+    Node* fixFrom;
+    if(left != NULL && right != NULL){
+        Node* successor = right;
+        while(successor->left.load(std::memory_order_relaxed) != NULL){
+            successor = successor->left.load(std::memory_order_relaxed);
+        }
+        //every node from right down to the successor's parent loses the successor's key
+        std::vector<Node*> shrinking;
+        for(Node* n = successor->parent ; n != node ; n = n->parent){
+            shrinking.push_back(n);
+            beginChange(n);
+        }
+        retire(node);
+        retire(successor);
+        Node* copy = new Node(successor->key, successor->value, NULL);
+        replace(node, copy);
+        //the successor has no left child, its right child takes its place
+        Node* successorParent = successor->parent == node ? copy : successor->parent;
+        Node* successorChild = successor->right.load(std::memory_order_relaxed);
+        if(successorChild != NULL){
+            successorChild->parent = successorParent;
+        }
+        linkTo(successorParent, successor).store(successorChild, std::memory_order_release);
+        for(std::size_t i = 0 ; i < shrinking.size() ; i++){
+            endChange(shrinking[i]);
+        }
+        fixFrom = successorParent;
+    } else {
+        Node* child = left != NULL ? left : right;
+        retire(node);
+        if(child != NULL){
+            child->parent = node->parent;
+        }
+        linkTo(node->parent, node).store(child, std::memory_order_release);
+        fixFrom = node->parent;
+    }
+    size_--;
+    rebalanceFrom(fixFrom);
+    reclaim();
+}
+
+/**
+ * node's right child rc takes its place and node becomes rc's left child. node loses rc and rc's
+ * right subtree, so it is marked while its links change; rc only gains keys
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::rotateLeft(Node* node)
+{
+    Node* rc = node->right.load(std::memory_order_relaxed);
+    Node* moved = rc->left.load(std::memory_order_relaxed);
+    Node* parent = node->parent;
+    beginChange(node);
+    node->right.store(moved, std::memory_order_release);
+    if(moved != NULL){ moved->parent = node; }
+    rc->left.store(node, std::memory_order_release);
+    node->parent = rc;
+    rc->parent = parent;
+    linkTo(parent, node).store(rc, std::memory_order_release);
+    endChange(node);
+    node->height = std::max(height(node->left.load(std::memory_order_relaxed)), height(moved)) + 1;
+    rc->height = std::max(node->height, height(rc->right.load(std::memory_order_relaxed))) + 1;
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::rotateRight(Node* node)
+{
+    Node* lc = node->left.load(std::memory_order_relaxed);
+    Node* moved = lc->right.load(std::memory_order_relaxed);
+    Node* parent = node->parent;
+    beginChange(node);
+    node->left.store(moved, std::memory_order_release);
+    if(moved != NULL){ moved->parent = node; }
+    lc->right.store(node, std::memory_order_release);
+    node->parent = lc;
+    lc->parent = parent;
+    linkTo(parent, node).store(lc, std::memory_order_release);
+    endChange(node);
+    node->height = std::max(height(moved), height(node->right.load(std::memory_order_relaxed))) + 1;
+    lc->height = std::max(height(lc->left.load(std::memory_order_relaxed)), node->height) + 1;
+}
+
+/**
+ * The writer keeps real heights (it is the only one reading them), and walks all the way up
+ * after every change, rotating wherever the heights differ by 2
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::rebalanceFrom(Node* node)
+{
+    while(node != NULL){
+        Node* left = node->left.load(std::memory_order_relaxed);
+        Node* right = node->right.load(std::memory_order_relaxed);
+        int balance = height(right) - height(left);
+        if(balance == 2){
+            if(height(right->left.load(std::memory_order_relaxed)) > height(right->right.load(std::memory_order_relaxed))){
+                rotateRight(right);
+            }
+            rotateLeft(node);
+            //node moved down, continue from the subtree's new root
+            node = node->parent;
+        } else if(balance == -2){
+            if(height(left->right.load(std::memory_order_relaxed)) > height(left->left.load(std::memory_order_relaxed))){
+                rotateLeft(left);
+            }
+            rotateRight(node);
+            node = node->parent;
+        } else {
+            node->height = std::max(height(left), height(right)) + 1;
+        }
+        node = node->parent;
+    }
+}
+
+/**
+ * The version goes odd and stays odd, so any reader on the node goes back to the root
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::retire(Node* node)
+{
+    beginChange(node);
+    retired_.push_back(node);
+}
+
+/**
+ * Once enough nodes wait: flips the epoch, so new readers count in the other one, and waits for
+ * the readers of the old epoch to finish. Every retired node was unlinked before the flip, so only
+ * those readers could still be on one
+ */
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::reclaim()
+{
+    if(retired_.size() < CONCURRENT_AVL_RECLAIM_BATCH){
+        return;
+    }
+    std::uint64_t old = epoch_.fetch_add(1);
+    for(int i = 0 ; i < CONCURRENT_AVL_READER_SLOTS ; i++){
+        //seq_cst, against the reader's increment then epoch check
+        while(readers_[i].count[old & 1].load() != 0){
+            std::this_thread::yield();
+        }
+    }
+    for(std::size_t i = 0 ; i < retired_.size() ; i++){
+        delete retired_[i];
+    }
+    retired_.clear();
+}
+
+template<class Key, class Value>
+template<class Fn>
+void ConcurrentAVLTree<Key, Value>::forEach(Fn fn) const
+{
+    std::lock_guard<std::mutex> lock(writeLock_);
+    forEachIn(root_.load(), fn);
+}
+
+template<class Key, class Value>
+template<class Fn>
+void ConcurrentAVLTree<Key, Value>::forEachIn(Node* node, Fn& fn) const
+{
+    if(node == NULL){
+        return;
+    }
+    forEachIn(node->left.load(std::memory_order_relaxed), fn);
+    fn(node->key, node->value);
+    forEachIn(node->right.load(std::memory_order_relaxed), fn);
+}
+
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::isBalanced() const
+{
+    std::lock_guard<std::mutex> lock(writeLock_);
+    return checkSubtree(root_.load(), NULL) != -1;
+}
+
+/**
+ * Helper function for isBalanced(): the subtree's height, or -1 if something is off
+ * */
+template<class Key, class Value>
+int ConcurrentAVLTree<Key, Value>::checkSubtree(Node* node, Node* parent) const
+{
+    if(node == NULL){
+        return 0;
+    }
+    Node* left = node->left.load(std::memory_order_relaxed);
+    Node* right = node->right.load(std::memory_order_relaxed);
+    if(node->parent != parent || (node->version.load() & 1) != 0){ return -1; }
+    if((left != NULL && !(left->key < node->key)) || (right != NULL && !(node->key < right->key))){ return -1; }
+    int l = checkSubtree(left, node);
+    int r = checkSubtree(right, node);
+    if(l == -1 || r == -1 || l - r > 1 || r - l > 1 || node->height != std::max(l, r) + 1){
+        return -1;
+    }
+    return node->height;
+}
+
+/*
+  -------------------------------------------------
+  End implementations for ConcurrentAVLTree.
+  -------------------------------------------------
+*/
+
+#endif
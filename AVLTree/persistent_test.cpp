@@ -0,0 +1,180 @@
+#include "persistentavl.h"
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Tree and std::map hold exactly the same items, in the same order
+ * */
+template<class K>
+bool sameItems(const PersistentAVLTree<K, int>& tree, const map<K, int>& expected){
+    typename PersistentAVLTree<K, int>::iterator it = tree.begin();
+    for(typename map<K, int>::const_iterator m = expected.begin() ; m != expected.end() ; ++m){
+        if(it == tree.end() || it->first != m->first || it->second != m->second){
+            return false;
+        }
+        ++it;
+    }
+    return it == tree.end() && tree.size() == expected.size();
+}
+
+int intKey(int x){
+    return x;
+}
+
+string stringKey(int x){
+    return "key_" + to_string(x);
+}
+
+/**
+ * Random inserts, overwrites and removes checked against std::map, taking a snapshot (and a
+ * copy of the map) every few hundred operations. At the end every snapshot must still hold
+ * what the tree held when it was taken
+ * returns the number of failed checks
+ * */
+template<class K>
+int snapshotTest(K (*makeKey)(int), int ops, int range){
+    int failed = 0;
+    mt19937 rng(99 + range);
+    PersistentAVLTree<K, int> tree;
+    map<K, int> expected;
+    vector<PersistentAVLTree<K, int> > snapshots;
+    vector<map<K, int> > snapshotItems;
+    for(int i = 0 ; i < ops ; i++){
+        K key = makeKey(rng() % range);
+        int op = rng() % 5;
+        if(op < 2){
+            tree.remove(key);
+            expected.erase(key);
+        } else if(op < 4){
+            int value = rng();
+            tree.insert(make_pair(key, value));
+            expected[key] = value;
+        } else {
+            const int* found = tree.find(key);
+            typename map<K, int>::iterator m = expected.find(key);
+            if((found == NULL) != (m == expected.end()) || (found != NULL && *found != m->second)){ failed++; }
+        }
+        if(i % 500 == 0){
+            snapshots.push_back(tree.snapshot());
+            snapshotItems.push_back(expected);
+            if(!tree.isBalanced()){ failed++; }
+        }
+    }
+    if(!tree.isBalanced() || !sameItems(tree, expected)){ failed++; }
+    for(size_t s = 0 ; s < snapshots.size() ; s++){
+        if(!snapshots[s].isBalanced() || !sameItems(snapshots[s], snapshotItems[s])){ failed++; }
+    }
+
+    //the live tree empties out, the snapshots don't notice
+    for(typename map<K, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+        tree.remove(m->first);
+    }
+    if(!tree.empty() || tree.begin() != tree.end()){ failed++; }
+    if(!snapshots.empty() && !sameItems(snapshots.back(), snapshotItems.back())){ failed++; }
+    return failed;
+}
+
+/**
+ * lower_bound and forEachInRange against std::map
+ * */
+int rangeTest(){
+    int failed = 0;
+    PersistentAVLTree<int, int> tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < 3000 ; i += 3){
+        tree.insert(make_pair(i, -i));
+        expected[i] = -i;
+    }
+    for(int lo = -5 ; lo < 3010 ; lo += 7){
+        int hi = lo + 50;
+        PersistentAVLTree<int, int>::iterator it = tree.lower_bound(lo);
+        map<int, int>::iterator m = expected.lower_bound(lo);
+        if((it == tree.end()) != (m == expected.end()) || (m != expected.end() && it->first != m->first)){ failed++; }
+        vector<int> keys;
+        tree.forEachInRange(lo, hi, [&keys](const pair<const int, int>& item){ keys.push_back(item.first); });
+        vector<int> wanted;
+        for(m = expected.lower_bound(lo) ; m != expected.end() && m->first < hi ; ++m){
+            wanted.push_back(m->first);
+        }
+        if(keys != wanted){ failed++; }
+    }
+    return failed;
+}
+
+/**
+ * A reader thread scans snapshots while the writer keeps changing the tree and publishing new
+ * snapshots: every scan sees all the stable even keys, in order, whatever the writer does with
+ * the odd ones. Only the copy of the published handle is locked, never the scan
+ * */
+int scanWhileWritingTest(){
+    const int stable = 2000;
+    PersistentAVLTree<int, int> tree;
+    for(int i = 0 ; i < stable ; i++){
+        tree.insert(make_pair(2 * i, i));
+    }
+    PersistentAVLTree<int, int> published = tree.snapshot();
+    mutex publishLock;
+    int failed = 0;
+    thread scanner([&published, &publishLock, &failed](){
+        for(int scan = 0 ; scan < 50 ; scan++){
+            PersistentAVLTree<int, int> view;
+            {
+                lock_guard<mutex> lock(publishLock);
+                view = published;
+            }
+            int evens = 0;
+            int last = -1;
+            for(PersistentAVLTree<int, int>::iterator it = view.begin() ; it != view.end() ; ++it){
+                if(it->first <= last){ failed++; }
+                last = it->first;
+                if(it->first % 2 == 0){ evens++; }
+            }
+            if(evens != stable){ failed++; }
+        }
+    });
+    mt19937 rng(3);
+    for(int i = 0 ; i < 100000 ; i++){
+        int key = 2 * (rng() % stable) + 1;
+        if(rng() % 2 == 0){
+            tree.insert(make_pair(key, i));
+        } else {
+            tree.remove(key);
+        }
+        if(i % 1000 == 0){
+            lock_guard<mutex> lock(publishLock);
+            published = tree.snapshot();
+        }
+    }
+    scanner.join();
+    return failed;
+}
+
+int main(){
+    if(snapshotTest<int>(intKey, 200000, 3000) != 0 || snapshotTest<int>(intKey, 50000, 100) != 0){
+        cout << "FAILED: int key snapshot test" << endl;
+        return 1;
+    }
+    if(snapshotTest<string>(stringKey, 50000, 2000) != 0){
+        cout << "FAILED: string key snapshot test" << endl;
+        return 1;
+    }
+    cout << "snapshot tests passed" << endl;
+    if(rangeTest() != 0){
+        cout << "FAILED: range test" << endl;
+        return 1;
+    }
+    cout << "range test passed" << endl;
+    if(scanWhileWritingTest() != 0){
+        cout << "FAILED: scan while writing test" << endl;
+        return 1;
+    }
+    cout << "scan while writing test passed" << endl;
+    return 0;
+}
@@ -0,0 +1,499 @@
+#ifndef PERSISTENTAVL_H
+#define PERSISTENTAVL_H
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * A node of PersistentAVLTree. Nodes never change once built, so any number of trees (and
+ * threads) can share them; they are freed by the reference count of the last tree that uses them.
+ */
+template <typename Key, typename Value>
+struct PersistentAVLNode
+{
+    typedef std::shared_ptr<const PersistentAVLNode<Key, Value> > Ptr;
+
+    PersistentAVLNode(const std::pair<const Key, Value>& item, const Ptr& left, const Ptr& right);
+
+    const std::pair<const Key, Value> item;
+    const Ptr left;
+    const Ptr right;
+    const int height;
+};
+
+/**
+ * An AVL tree whose versions all stay valid: insert and remove copy the O(log n) nodes on the
+ * path to the key and share every other subtree with the version before, so a snapshot is a
+ * copy of the root pointer, O(1), and never changes while the tree it came from moves on.
+ *
+ * A long-running scan takes a snapshot and walks it while the writer keeps updating the tree,
+ * without any lock between them. Snapshots may be handed to other threads (the reference counts
+ * are atomic), but one PersistentAVLTree object must not be changed and read at the same time,
+ * like any other standard container.
+ *
+ * Every update allocates O(log n) new nodes and copies their items, so it is slower than
+ * AVLTree::insert; lookups and scans cost the same.
+ */
+template <typename Key, typename Value>
+class PersistentAVLTree
+{
+public:
+    typedef PersistentAVLNode<Key, Value> Node;
+    typedef typename Node::Ptr NodePtr;
+
+    PersistentAVLTree();
+
+    //the tree as it is now, unchanged by later inserts and removes on this tree, O(1)
+    PersistentAVLTree<Key, Value> snapshot() const;
+    //inserts or overwrites the item
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    //pointer to the value of key, or NULL if key is missing; valid while this version lives
+    const Value* find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::size_t size() const;
+    bool empty() const;
+    //calls fn(item) on every item with lo <= key < hi, in key order
+    template<class Fn>
+    void forEachInRange(const Key& lo, const Key& hi, Fn fn) const;
+    //checks heights, balance and order
+    bool isBalanced() const;
+
+    /**
+     * In-order iterator over one version, which must outlive the iterator.
+     * It keeps the path from the root on a stack since nodes have no parent pointers
+     * (a node can be in many versions, each with another parent).
+     */
+    class iterator
+    {
+    public:
+        iterator();
+        const std::pair<const Key, Value>& operator*() const;
+        const std::pair<const Key, Value>* operator->() const;
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+        iterator& operator++();
+
+    protected:
+        friend class PersistentAVLTree<Key, Value>;
+        //pushes node and its chain of left children
+        void pushLeft(const Node* node);
+        std::vector<const Node*> path_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    //iterator to the smallest key >= key
+    iterator lower_bound(const Key& key) const;
+
+protected:
+    static int height(const NodePtr& node);
+    static NodePtr makeNode(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right);
+    //a new node for item over left and right, rotated if their heights differ by 2
+    static NodePtr balance(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right);
+    static NodePtr insertInto(const NodePtr& node, const std::pair<const Key, Value>& item, bool& added);
+    //returns node itself if key is missing, so nothing gets copied
+    static NodePtr removeFrom(const NodePtr& node, const Key& key, bool& removed);
+    //the subtree without its smallest node, which goes to min
+    static NodePtr removeMin(const NodePtr& node, const Node*& min);
+    template<class Fn>
+    static void forEachIn(const Node* node, const Key& lo, const Key& hi, Fn& fn);
+    static int checkSubtree(const Node* node);
+
+    NodePtr root_;
+    std::size_t size_;
+};
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for PersistentAVLNode.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+PersistentAVLNode<Key, Value>::PersistentAVLNode(const std::pair<const Key, Value>& item, const Ptr& left, const Ptr& right) :
+    item(item),
+    left(left),
+    right(right),
+    height(std::max(left ? left->height : 0, right ? right->height : 0) + 1)
+{
+
+}
+
+/*
+  -------------------------------------------------
+  End implementations for PersistentAVLNode.
+  -------------------------------------------------
+*/
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for PersistentAVLTree::iterator.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::iterator::iterator()
+{
+
+}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>&
+PersistentAVLTree<Key, Value>::iterator::operator*() const
+{
+    return path_.back()->item;
+}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>*
+PersistentAVLTree<Key, Value>::iterator::operator->() const
+{
+    return &(path_.back()->item);
+}
+
+template<class Key, class Value>
+bool
+PersistentAVLTree<Key, Value>::iterator::operator==(const iterator& rhs) const
+{
+    if(path_.empty() || rhs.path_.empty()){
+        return path_.empty() == rhs.path_.empty();
+    }
+    return path_.back() == rhs.path_.back();
+}
+
+template<class Key, class Value>
+bool
+PersistentAVLTree<Key, Value>::iterator::operator!=(const iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::iterator::pushLeft(const Node* node)
+{
+    while(node != NULL){
+        path_.push_back(node);
+        node = node->left.get();
+    }
+}
+
+/**
+ * The stack holds only the nodes still to be visited: the current one on top, then the
+ * ancestors it is in the left subtree of. The successor is the leftmost node of the right
+ * subtree, or else the next ancestor on the stack
+ * runtime = O(1) amortized
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator&
+PersistentAVLTree<Key, Value>::iterator::operator++()
+{
+    const Node* node = path_.back();
+    path_.pop_back();
+    pushLeft(node->right.get());
+    return *this;
+}
+
+/*
+  -------------------------------------------------
+  End implementations for PersistentAVLTree::iterator.
+  -------------------------------------------------
+*/
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for PersistentAVLTree.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree() :
+    size_(0)
+{
+
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value> PersistentAVLTree<Key, Value>::snapshot() const
+{
+    return *this;
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    bool added = false;
+    root_ = insertInto(root_, keyValuePair, added);
+    if(added){
+        size_++;
+    }
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::remove(const Key& key)
+{
+    bool removed = false;
+    root_ = removeFrom(root_, key, removed);
+    if(removed){
+        size_--;
+    }
+}
+
+/**
+ * Nodes still used by snapshots stay alive
+ */
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::clear()
+{
+    root_.reset();
+    size_ = 0;
+}
+
+template<class Key, class Value>
+const Value* PersistentAVLTree<Key, Value>::find(const Key& key) const
+{
+    const Node* node = root_.get();
+    while(node != NULL){
+        if(key < node->item.first){
+            node = node->left.get();
+        } else if(node->item.first < key){
+            node = node->right.get();
+        } else {
+            return &(node->item.second);
+        }
+    }
+    return NULL;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::contains(const Key& key) const
+{
+    return find(key) != NULL;
+}
+
+template<class Key, class Value>
+std::size_t PersistentAVLTree<Key, Value>::size() const
+{
+    return size_;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::empty() const
+{
+    return size_ == 0;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::begin() const
+{
+    iterator it;
+    it.pushLeft(root_.get());
+    return it;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::end() const
+{
+    return iterator();
+}
+
+/**
+ * Keeps the nodes where the walk went left, those are the keys still to come after the bound
+ * runtime = O(log n)
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::lower_bound(const Key& key) const
+{
+    iterator it;
+    const Node* node = root_.get();
+    while(node != NULL){
+        if(node->item.first < key){
+            node = node->right.get();
+        } else {
+            it.path_.push_back(node);
+            node = node->left.get();
+        }
+    }
+    return it;
+}
+
+template<class Key, class Value>
+template<class Fn>
+void PersistentAVLTree<Key, Value>::forEachInRange(const Key& lo, const Key& hi, Fn fn) const
+{
+    forEachIn(root_.get(), lo, hi, fn);
+}
+
+/**
+ * Skips the subtrees that are entirely out of range
+ * runtime = O(log n + k) for k items in range
+ */
+template<class Key, class Value>
+template<class Fn>
+void PersistentAVLTree<Key, Value>::forEachIn(const Node* node, const Key& lo, const Key& hi, Fn& fn)
+{
+    if(node == NULL){
+        return;
+    }
+    bool aboveLo = !(node->item.first < lo);
+    bool belowHi = node->item.first < hi;
+    if(aboveLo){
+        forEachIn(node->left.get(), lo, hi, fn);
+    }
+    if(aboveLo && belowHi){
+        fn(node->item);
+    }
+    if(belowHi){
+        forEachIn(node->right.get(), lo, hi, fn);
+    }
+}
+
+template<class Key, class Value>
+int PersistentAVLTree<Key, Value>::height(const NodePtr& node)
+{
+    return node ? node->height : 0;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::makeNode(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right)
+{
+    return std::make_shared<const Node>(item, left, right);
+}
+
+/**
+ * Same single and double rotations as AVLTree, but building new nodes instead of relinking:
+ * left and right differ in height by at most 2, and the result is a balanced subtree
+ * runtime = O(1)
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::balance(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right)
+{
+    int hl = height(left);
+    int hr = height(right);
+    if(hl > hr + 1){
+        if(height(left->left) >= height(left->right)){
+            return makeNode(left->item, left->left, makeNode(item, left->right, right));
+        }
+        const NodePtr& middle = left->right;
+        return makeNode(middle->item, makeNode(left->item, left->left, middle->left), makeNode(item, middle->right, right));
+    }
+    if(hr > hl + 1){
+        if(height(right->right) >= height(right->left)){
+            return makeNode(right->item, makeNode(item, left, right->left), right->right);
+        }
+        const NodePtr& middle = right->left;
+        return makeNode(middle->item, makeNode(item, left, middle->left), makeNode(right->item, middle->right, right->right));
+    }
+    return makeNode(item, left, right);
+}
+
+/**
+ * Copies the path down to the key on the way back up, rebalancing each copy
+ * runtime = O(log n)
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::insertInto(const NodePtr& node, const std::pair<const Key, Value>& item, bool& added)
+{
+    if(!node){
+        added = true;
+        return makeNode(item, NodePtr(), NodePtr());
+    }
+    if(item.first < node->item.first){
+        return balance(node->item, insertInto(node->left, item, added), node->right);
+    }
+    if(node->item.first < item.first){
+        return balance(node->item, node->left, insertInto(node->right, item, added));
+    }
+    return makeNode(item, node->left, node->right);
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::removeFrom(const NodePtr& node, const Key& key, bool& removed)
+{
+    if(!node){
+        return node;
+    }
+    if(key < node->item.first){
+        NodePtr left = removeFrom(node->left, key, removed);
+        return removed ? balance(node->item, left, node->right) : node;
+    }
+    if(node->item.first < key){
+        NodePtr right = removeFrom(node->right, key, removed);
+        return removed ? balance(node->item, node->left, right) : node;
+    }
+    removed = true;
+    if(!node->left){
+        return node->right;
+    }
+    if(!node->right){
+        return node->left;
+    }
+    //the successor takes the node's place
+    const Node* min = NULL;
+    NodePtr right = removeMin(node->right, min);
+    return balance(min->item, node->left, right);
+}
+
+/**
+ * min stays alive after the call: the old subtree, which still holds it, is owned by the caller
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::removeMin(const NodePtr& node, const Node*& min)
+{
+    if(!node->left){
+        min = node.get();
+        return node->right;
+    }
+    return balance(node->item, removeMin(node->left, min), node->right);
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::isBalanced() const
+{
+    return checkSubtree(root_.get()) != -1;
+}
+
+/**
+ * Helper function for isBalanced(): the subtree's height, or -1 if something is off
+ * */
+template<class Key, class Value>
+int PersistentAVLTree<Key, Value>::checkSubtree(const Node* node)
+{
+    if(node == NULL){
+        return 0;
+    }
+    const Node* left = node->left.get();
+    const Node* right = node->right.get();
+    if((left != NULL && !(left->item.first < node->item.first)) || (right != NULL && !(node->item.first < right->item.first))){
+        return -1;
+    }
+    int l = checkSubtree(left);
+    int r = checkSubtree(right);
+    if(l == -1 || r == -1 || l - r > 1 || r - l > 1 || node->height != std::max(l, r) + 1){
+        return -1;
+    }
+    return node->height;
+}
+
+/*
+  -------------------------------------------------
+  End implementations for PersistentAVLTree.
+  -------------------------------------------------
+*/
+
+#endif
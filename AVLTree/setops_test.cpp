@@ -0,0 +1,300 @@
+#include "avlbst.h"
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace std;
+
+/**
+ * Tree and std::map hold exactly the same items, in the same order, and the tree's
+ * order statistics still add up
+ * */
+template<class Tree>
+bool sameItems(Tree& tree, const map<int, int>& expected){
+    typename Tree::iterator it = tree.begin();
+    for(map<int, int>::const_iterator m = expected.begin() ; m != expected.end() ; ++m){
+        if(it == tree.end() || it->first != m->first || it->second != m->second){
+            return false;
+        }
+        ++it;
+    }
+    if(it != tree.end() || tree.size() != expected.size() || !tree.isBalanced()){
+        return false;
+    }
+    //rank walks the subtree sizes, rbegin starts at the largest node
+    if(!expected.empty() && (tree.rank(expected.rbegin()->first) != expected.size() - 1 || tree.rbegin()->first != expected.rbegin()->first)){
+        return false;
+    }
+    return true;
+}
+
+template<class Tree>
+void fill(Tree& tree, map<int, int>& expected, mt19937& rng, int n, int lo, int range){
+    for(int i = 0 ; i < n ; i++){
+        int key = lo + rng() % range;
+        tree.insert(make_pair(key, i));
+        expected[key] = i;
+    }
+}
+
+/**
+ * Random trees of very different sizes (so joins meet trees of very different heights),
+ * combined with every operation and checked against std::map. The result must still take
+ * inserts and removes afterwards
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int setOperationTest(int seed){
+    int failed = 0;
+    mt19937 rng(seed);
+    for(int round = 0 ; round < 60 ; round++){
+        int limit = round % 3 == 0 ? 50 : 20000;
+        int range = 1 + rng() % 100000;
+        Tree a, b;
+        map<int, int> ma, mb;
+        fill(a, ma, rng, rng() % limit, 0, range);
+        fill(b, mb, rng, rng() % limit, 0, range);
+        map<int, int> result;
+        switch(round % 5){
+        case 0:
+            a.unionWith(b);
+            result = ma;
+            result.insert(mb.begin(), mb.end());
+            break;
+        case 1:
+            a.intersectWith(b);
+            for(map<int, int>::iterator m = ma.begin() ; m != ma.end() ; ++m){
+                if(mb.count(m->first)){ result.insert(*m); }
+            }
+            break;
+        case 2:
+            a.subtract(b);
+            for(map<int, int>::iterator m = ma.begin() ; m != ma.end() ; ++m){
+                if(!mb.count(m->first)){ result.insert(*m); }
+            }
+            break;
+        case 3: {
+            //split and join back together
+            int key = rng() % range;
+            Tree greater;
+            a.split(key, greater);
+            map<int, int> less(ma.begin(), ma.lower_bound(key));
+            map<int, int> more(ma.lower_bound(key), ma.end());
+            if(!sameItems(a, less) || !sameItems(greater, more)){ failed++; }
+            if(!more.empty()){
+                pair<int, int> first = *more.begin();
+                greater.remove(first.first);
+                a.join(first.first, first.second, greater);
+                if(!greater.empty()){ failed++; }
+            }
+            result = ma;
+            break;
+        }
+        default: {
+            //join with a tree of bigger keys
+            Tree c;
+            map<int, int> mc;
+            fill(c, mc, rng, rng() % limit, range + 1, range);
+            a.join(range, -1, c);
+            result = ma;
+            result[range] = -1;
+            result.insert(mc.begin(), mc.end());
+            if(!c.empty()){ failed++; }
+        }
+        }
+        if(!sameItems(a, result) || !sameItems(b, mb)){ failed++; }
+        for(int i = 0 ; i < 1000 ; i++){
+            int key = rng() % range;
+            if(i % 2 == 0){
+                a.insert(make_pair(key, i));
+                result[key] = i;
+            } else {
+                a.remove(key);
+                result.erase(key);
+            }
+        }
+        if(!sameItems(a, result)){ failed++; }
+    }
+    return failed;
+}
+
+/**
+ * After split the two halves share one pool: clearing either one must leave the other's
+ * nodes alone, and both keep working on their own
+ * returns the number of failed checks
+ * */
+int splitSharesPoolTest(){
+    int failed = 0;
+    for(int clearFirst = 0 ; clearFirst < 2 ; clearFirst++){
+        AVLTree<int, int> a, greater;
+        map<int, int> ma;
+        for(int i = 0 ; i < 10000 ; i++){
+            a.insert(make_pair(i, -i));
+            ma[i] = -i;
+        }
+        a.split(5000, greater);
+        map<int, int> less(ma.begin(), ma.find(5000));
+        map<int, int> more(ma.find(5000), ma.end());
+        AVLTree<int, int>& cleared = clearFirst ? greater : a;
+        AVLTree<int, int>& kept = clearFirst ? a : greater;
+        map<int, int>& keptItems = clearFirst ? less : more;
+        cleared.clear();
+        for(int i = 0 ; i < 1000 ; i++){
+            cleared.insert(make_pair(20000 + i, i));
+            kept.insert(make_pair(30000 + i, i));
+            keptItems[30000 + i] = i;
+        }
+        if(!sameItems(kept, keptItems) || cleared.size() != 1000){ failed++; }
+    }
+    return failed;
+}
+
+//a value that counts how many of it are alive, so leaked or twice destroyed nodes show up
+struct Counted{
+    static int alive;
+    int x;
+    Counted(int x = 0) : x(x){ alive++; }
+    Counted(const Counted& other) : x(other.x){ alive++; }
+    Counted& operator=(const Counted& other){ x = other.x; return *this; }
+    ~Counted(){ alive--; }
+};
+int Counted::alive = 0;
+
+typedef AVLTree<int, Counted> CountedTree;
+
+//the memory of key's node, a new node in the same place reused the slot
+const void* slotOf(CountedTree& tree, int key){
+    CountedTree::iterator it = tree.find(key);
+    return it == tree.end() ? NULL : (const void*)&it->second;
+}
+
+/**
+ * Which pool a node comes from shows in where it lands: the pool hands out the last freed slot
+ * first. A removed node's slot is reused by the next insert, after split by the other half too,
+ * and after join a tree that shared the adopted pool ends up sharing the joined tree's pool
+ * returns the number of failed checks
+ * */
+int poolSharingTest(){
+    int failed = 0;
+    {
+        CountedTree t, g, c, d, e;
+        for(int i = 0 ; i < 1000 ; i++){
+            t.insert(make_pair(i, Counted(i)));
+        }
+        const void* slot = slotOf(t, 500);
+        t.remove(500);
+        t.insert(make_pair(2000, Counted(2000)));
+        if(slotOf(t, 2000) != slot){ failed++; }
+
+        //t and g share one pool
+        t.split(500, g);
+        slot = slotOf(g, 700);
+        g.remove(700);
+        t.insert(make_pair(3000, Counted(3000)));
+        if(slotOf(t, 3000) != slot || t.size() != 501 || g.size() != 499){ failed++; }
+
+        //c and d share a pool, which t's pool adopts when c joins t. d follows it
+        for(int i = 10000 ; i < 11000 ; i++){
+            c.insert(make_pair(i, Counted(i)));
+        }
+        c.split(10500, d);
+        t.join(5000, Counted(5000), c);
+        slot = slotOf(d, 10600);
+        d.remove(10600);
+        t.insert(make_pair(4000, Counted(4000)));
+        if(slotOf(t, 4000) != slot || !c.empty() || t.size() != 1003){ failed++; }
+
+        //a set operation, then a join with a tree that never shared anything
+        for(int i = 0 ; i < 2000 ; i += 3){
+            e.insert(make_pair(i, Counted(-i)));
+        }
+        t.unionWith(e);
+        t.subtract(g);
+        map<int, int> expected;
+        for(CountedTree::iterator it = t.begin() ; it != t.end() ; ++it){
+            expected[it->first] = it->second.x;
+        }
+        CountedTree f;
+        for(int i = 20000 ; i < 20100 ; i++){
+            f.insert(make_pair(i, Counted(i)));
+            expected[i] = i;
+        }
+        t.join(19999, Counted(0), f);
+        expected[19999] = 0;
+        if(t.size() != expected.size() || !t.isBalanced()){ failed++; }
+        for(map<int, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+            CountedTree::iterator it = t.find(m->first);
+            if(it == t.end() || it->second.x != m->second){ failed++; }
+        }
+        if(Counted::alive != (int)(t.size() + g.size() + d.size() + e.size())){ failed++; }
+
+        //clearing one tree of a shared pool leaves the others alone
+        g.clear();
+        d.clear();
+        if(Counted::alive != (int)(t.size() + e.size())){ failed++; }
+        for(int i = 0 ; i < 100 ; i++){
+            g.insert(make_pair(i, Counted(i)));
+            t.remove(i);
+        }
+        if(!t.isBalanced() || g.size() != 100 || Counted::alive != (int)(t.size() + e.size() + g.size())){ failed++; }
+    }
+    if(Counted::alive != 0){ failed++; }
+    return failed;
+}
+
+/**
+ * Copies and rebinds of a PoolAllocator share its pool, so they compare equal and free each
+ * other's memory. After adopt, allocators that still point at the adopted pool follow it
+ * returns the number of failed checks
+ * */
+int poolAllocatorTest(){
+    int failed = 0;
+    PoolAllocator<long> a;
+    PoolAllocator<long> copy(a);
+    PoolAllocator<char> rebound(a);
+    PoolAllocator<long> back(rebound);
+    if(!(a == copy) || !(a == rebound) || !(back == a) || a != copy){ failed++; }
+    long* p = a.allocate(1);
+    *p = 1;
+    back.deallocate(p, 1);
+    if(a.ownsPool()){ failed++; }
+
+    PoolAllocator<long> b;
+    PoolAllocator<long> bCopy(b);
+    if(a == b){ failed++; }
+    long* fromB = b.allocate(1);
+    a.adopt(b);
+    if(!(a == bCopy) || a == b){ failed++; }
+    //b's old memory is a's now, bCopy followed it there
+    bCopy.deallocate(fromB, 1);
+    long* again = a.allocate(1);
+    a.deallocate(again, 1);
+    if(!b.ownsPool()){ failed++; }
+    return failed;
+}
+
+int main(){
+    if(poolAllocatorTest() != 0){
+        cout << "FAILED: pool allocator copies and adopt" << endl;
+        return 1;
+    }
+    if(setOperationTest<AVLTree<int, int> >(1) != 0){
+        cout << "FAILED: set operations with the pool allocator" << endl;
+        return 1;
+    }
+    cout << "pool allocator test passed" << endl;
+    if(poolSharingTest() != 0){
+        cout << "FAILED: trees sharing and adopting pools" << endl;
+        return 1;
+    }
+    if(splitSharesPoolTest() != 0){
+        cout << "FAILED: split halves sharing a pool" << endl;
+        return 1;
+    }
+    if(setOperationTest<AVLTree<int, int, allocator<pair<const int, int> > > >(2) != 0){
+        cout << "FAILED: set operations with std::allocator" << endl;
+        return 1;
+    }
+    cout << "std::allocator test passed" << endl;
+    return 0;
+}
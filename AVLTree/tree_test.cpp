@@ -0,0 +1,743 @@
+#include "avlbst.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A tree that also lets the tests look at its inside: the cached largest node, and for
+ * AVLTree the subtree sizes
+ * */
+template<class Tree>
+class Inspected : public Tree
+{
+public:
+    //rightmost_ is the node with the largest key (NULL for an empty tree)
+    bool rightmostOk() const
+    {
+        return this->rightmost_ == this->getLargestNode();
+    }
+    //every node's size is the number of nodes in its subtree, AVLTree only
+    bool sizesOk() const
+    {
+        bool ok = true;
+        subtreeSize(this->root_, ok);
+        return ok;
+    }
+    //every node's balance factor is its right height minus its left height, AVLTree only
+    bool balancesOk() const
+    {
+        bool ok = true;
+        checkedHeight(this->root_, ok);
+        return ok;
+    }
+    //number of nodes on the longest path down from the root
+    int height() const
+    {
+        bool ok = true;
+        return plainHeight(this->root_, ok);
+    }
+private:
+    template<class NodeT>
+    static size_t subtreeSize(const NodeT* node, bool& ok)
+    {
+        if(node == NULL){
+            return 0;
+        }
+        size_t size = subtreeSize(node->getLeft(), ok) + subtreeSize(node->getRight(), ok) + 1;
+        if(node->getSize() != size){
+            ok = false;
+        }
+        return size;
+    }
+    template<class NodeT>
+    static int plainHeight(const NodeT* node, bool& ok)
+    {
+        if(node == NULL){
+            return 0;
+        }
+        return max(plainHeight(node->getLeft(), ok), plainHeight(node->getRight(), ok)) + 1;
+    }
+    template<class NodeT>
+    static int checkedHeight(const NodeT* node, bool& ok)
+    {
+        if(node == NULL){
+            return 0;
+        }
+        int left = checkedHeight(node->getLeft(), ok);
+        int right = checkedHeight(node->getRight(), ok);
+        if(node->getBalance() != right - left){
+            ok = false;
+        }
+        return max(left, right) + 1;
+    }
+};
+
+typedef Inspected<AVLTree<int, string> > StringAVL;
+typedef Inspected<AVLTree<int, string, allocator<pair<const int, string> > > > StdStringAVL;
+typedef Inspected<BinarySearchTree<int, string> > StringBST;
+typedef Inspected<AVLTree<int, int> > IntAVL;
+typedef Inspected<AVLTree<int, int, allocator<pair<const int, int> > > > StdIntAVL;
+typedef Inspected<BinarySearchTree<int, int> > IntBST;
+
+//a value that counts how many of it are alive, so nodes that were never destroyed show up
+struct Counted{
+    static int alive;
+    int x;
+    Counted(int x = 0) : x(x){ alive++; }
+    Counted(const Counted& other) : x(other.x){ alive++; }
+    Counted& operator=(const Counted& other){ x = other.x; return *this; }
+    ~Counted(){ alive--; }
+};
+int Counted::alive = 0;
+
+//the value stored for key. int has no destructor, so clear() with the pool skips the walk
+template<class V>
+V valueOf(int key);
+
+template<>
+string valueOf<string>(int key){
+    return "value_" + to_string(key);
+}
+
+template<>
+int valueOf<int>(int key){
+    return -key;
+}
+
+/**
+ * Tree and std::map hold exactly the same items, in the same order, walking forward
+ * */
+template<class Tree, class V>
+bool sameItems(const Tree& tree, const map<int, V>& expected)
+{
+    typename Tree::iterator it = tree.begin();
+    for(typename map<int, V>::const_iterator m = expected.begin() ; m != expected.end() ; ++m){
+        if(it == tree.end() || it->first != m->first || !(it->second == m->second)){
+            return false;
+        }
+        ++it;
+    }
+    return it == tree.end() && tree.empty() == expected.empty();
+}
+
+/**
+ * clear() empties the tree whichever way it frees the nodes (a walk, or just the pool's
+ * chunks), and the tree takes new items afterwards, more than once
+ * returns the number of failed checks
+ * */
+template<class Tree, class V>
+int clearTest(int seed)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    Tree tree;
+    for(int round = 0 ; round < 3 ; round++){
+        map<int, V> expected;
+        for(int i = 0 ; i < 3000 ; i++){
+            int key = rng() % 5000;
+            tree.insert(make_pair(key, valueOf<V>(key + round)));
+            expected[key] = valueOf<V>(key + round);
+        }
+        if(!sameItems(tree, expected) || !tree.rightmostOk()){ failed++; }
+        tree.clear();
+        if(!tree.empty() || tree.begin() != tree.end() || !tree.rightmostOk()){ failed++; }
+        tree.clear();
+        if(!tree.empty()){ failed++; }
+    }
+    //the destructor runs the same teardown on a full tree
+    for(int i = 0 ; i < 1000 ; i++){
+        tree.insert(make_pair(i, valueOf<V>(i)));
+    }
+    return failed;
+}
+
+/**
+ * Values with a destructor are destroyed by clear() and by the destructor, with the pool
+ * (which frees its chunks at once) and without it
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int destructorTest()
+{
+    int failed = 0;
+    {
+        Tree tree;
+        for(int i = 0 ; i < 2000 ; i++){
+            tree.insert(make_pair((i * 7919) % 2000, Counted(i)));
+        }
+        if(Counted::alive != 2000){ failed++; }
+        tree.clear();
+        if(Counted::alive != 0){ failed++; }
+        for(int i = 0 ; i < 500 ; i++){
+            tree.insert(make_pair(i, Counted(i)));
+        }
+        tree.remove(7);
+        if(Counted::alive != 499){ failed++; }
+    }
+    if(Counted::alive != 0){ failed++; }
+    return failed;
+}
+
+/**
+ * The AVLTree part of buildTest(): balance factors, sizes, select() and rank() on the built
+ * tree, then the same after random inserts and removes
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int avlBuildChecks(Tree& tree, map<int, int> expected, mt19937& rng)
+{
+    int failed = 0;
+    if(!tree.sizesOk() || !tree.balancesOk() || tree.size() != expected.size()){ failed++; }
+    size_t i = 0;
+    for(map<int, int>::iterator m = expected.begin() ; m != expected.end() ; ++m, i++){
+        if(tree.select(i) == tree.end() || tree.select(i)->first != m->first || tree.rank(m->first) != i){ failed++; }
+    }
+    if(tree.select(expected.size()) != tree.end()){ failed++; }
+    int range = 2 * (int)expected.size() + 10;
+    for(int j = 0 ; j < 500 ; j++){
+        int key = rng() % range;
+        if(j % 2 == 0){
+            tree.insert(make_pair(key, j));
+            expected[key] = j;
+        } else {
+            tree.remove(key);
+            expected.erase(key);
+        }
+    }
+    if(!sameItems(tree, expected) || !tree.isBalanced() || !tree.sizesOk() || !tree.balancesOk() || !tree.rightmostOk()){ failed++; }
+    return failed;
+}
+
+//a plain BST keeps no balance factors or sizes
+template<class Alloc, class NodeT>
+int avlBuildChecks(Inspected<BinarySearchTree<int, int, Alloc, NodeT> >&, map<int, int>, mt19937&)
+{
+    return 0;
+}
+
+/**
+ * buildFromSorted() replaces whatever was in the tree with a tree of the smallest possible
+ * height, and for AVLTree leaves the same balance factors and sizes inserts would have, so
+ * select(), rank() and later inserts and removes work on it. sortAndBuild() keeps the last
+ * value of a repeated key
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int buildTest(int seed)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    const size_t sizes[] = { 0, 1, 2, 3, 7, 8, 100, 1023, 1024, 5000 };
+    for(size_t s = 0 ; s < sizeof(sizes) / sizeof(sizes[0]) ; s++){
+        size_t n = sizes[s];
+        vector<pair<int, int> > items;
+        map<int, int> expected;
+        for(size_t i = 0 ; i < n ; i++){
+            items.push_back(make_pair(2 * (int)i, (int)i));
+            expected[2 * i] = i;
+        }
+        Tree tree;
+        tree.insert(make_pair(-5, 0));
+        tree.insert(make_pair(1000000, 0));
+        tree.buildFromSorted(items.begin(), items.end());
+        int minHeight = 0;
+        while(((size_t)1 << minHeight) - 1 < n){
+            minHeight++;
+        }
+        if(!sameItems(tree, expected) || tree.height() != minHeight || !tree.isBalanced() || !tree.rightmostOk()){ failed++; }
+        failed += avlBuildChecks(tree, expected, rng);
+
+        //every key three times, shuffled, the last value wins
+        vector<pair<int, int> > repeated;
+        for(int round = 0 ; round < 3 ; round++){
+            for(size_t i = 0 ; i < n ; i++){
+                repeated.push_back(make_pair((int)i, (int)rng()));
+            }
+        }
+        shuffle(repeated.begin(), repeated.end(), rng);
+        map<int, int> lastValue;
+        for(size_t i = 0 ; i < repeated.size() ; i++){
+            lastValue[repeated[i].first] = repeated[i].second;
+        }
+        tree.sortAndBuild(repeated.begin(), repeated.end());
+        if(!sameItems(tree, lastValue) || tree.height() != minHeight || !tree.isBalanced() || !tree.rightmostOk()){ failed++; }
+        failed += avlBuildChecks(tree, lastValue, rng);
+    }
+    return failed;
+}
+
+/**
+ * Random inserts and removes against std::map. Every so often select(i) is checked for every i,
+ * rank() for every key in the range and the ones around it, and countRange() for every pair of
+ * them, which all only add up if every subtree size is right
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int orderStatisticsTest(int seed)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    const int range = 300;
+    Tree tree;
+    map<int, int> expected;
+    for(int step = 1 ; step <= 6000 ; step++){
+        int key = rng() % range;
+        //inserts win early on so the tree fills up, removes later so it empties again
+        if((int)(rng() % 6000) >= step){
+            tree.insert(make_pair(key, step));
+            expected[key] = step;
+        } else {
+            tree.remove(key);
+            expected.erase(key);
+        }
+        if(step % 250 != 0){
+            continue;
+        }
+        if(tree.size() != expected.size() || !tree.sizesOk() || !tree.isBalanced()){ failed++; }
+        vector<int> keys;
+        for(map<int, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+            keys.push_back(m->first);
+        }
+        for(size_t i = 0 ; i < keys.size() ; i++){
+            typename Tree::iterator it = tree.select(i);
+            if(it == tree.end() || it->first != keys[i]){ failed++; }
+        }
+        if(tree.select(keys.size()) != tree.end()){ failed++; }
+        for(int k = -1 ; k <= range ; k++){
+            size_t smaller = lower_bound(keys.begin(), keys.end(), k) - keys.begin();
+            if(tree.rank(k) != smaller){ failed++; }
+        }
+        for(int lo = -1 ; lo <= range ; lo++){
+            for(int hi = -1 ; hi <= range ; hi++){
+                size_t inRange = 0;
+                if(lo < hi){
+                    inRange = lower_bound(keys.begin(), keys.end(), hi) - lower_bound(keys.begin(), keys.end(), lo);
+                }
+                if(tree.countRange(lo, hi) != inRange){ failed++; }
+            }
+        }
+    }
+    return failed;
+}
+
+//the tree iterator points at the same key as the map iterator, or both are at the end
+template<class Tree, class It>
+bool sameKey(const Tree& tree, typename Tree::iterator it, const map<int, int>& expected, It m)
+{
+    if(m == expected.end()){
+        return it == tree.end();
+    }
+    return it != tree.end() && it->first == m->first;
+}
+
+/**
+ * lower_bound, upper_bound and equal_range at every key around the tree's (every other key
+ * is missing), forEachInRange over ranges that start and end at missing keys, the first and
+ * last key, and empty or inverted ranges, and full walks both ways with both iterators,
+ * stepping back with operator-- at every position. All against std::map
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int lookupTest(int seed, int n)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    const int range = 2 * n + 4;
+    Tree tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < n ; i++){
+        int key = 2 * (rng() % (n + 1));
+        tree.insert(make_pair(key, i));
+        expected[key] = i;
+    }
+    for(int k = -2 ; k <= range ; k++){
+        if(!sameKey(tree, tree.lower_bound(k), expected, expected.lower_bound(k))){ failed++; }
+        if(!sameKey(tree, tree.upper_bound(k), expected, expected.upper_bound(k))){ failed++; }
+        pair<typename Tree::iterator, typename Tree::iterator> found = tree.equal_range(k);
+        if(!sameKey(tree, found.first, expected, expected.equal_range(k).first)){ failed++; }
+        if(!sameKey(tree, found.second, expected, expected.equal_range(k).second)){ failed++; }
+    }
+
+    vector<int> bounds;
+    bounds.push_back(-2);
+    bounds.push_back(range);
+    if(!expected.empty()){
+        bounds.push_back(expected.begin()->first);
+        bounds.push_back(expected.rbegin()->first);
+        bounds.push_back(expected.rbegin()->first + 1);
+    }
+    for(int i = 0 ; i < 20 ; i++){
+        bounds.push_back(rng() % range);
+    }
+    for(size_t a = 0 ; a < bounds.size() ; a++){
+        for(size_t b = 0 ; b < bounds.size() ; b++){
+            int lo = bounds[a], hi = bounds[b];
+            vector<int> visited, inRange;
+            tree.forEachInRange(lo, hi, [&visited](const pair<const int, int>& item){ visited.push_back(item.first); });
+            if(lo < hi){
+                for(map<int, int>::iterator m = expected.lower_bound(lo) ; m != expected.lower_bound(hi) ; ++m){
+                    inRange.push_back(m->first);
+                }
+            }
+            if(visited != inRange){ failed++; }
+        }
+    }
+
+    //forward, and one step back from every item
+    typename Tree::iterator it = tree.begin();
+    for(map<int, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+        if(!sameKey(tree, it, expected, m)){ failed++; break; }
+        typename Tree::iterator back = it;
+        --back;
+        if(m == expected.begin() ? back != tree.end() : !sameKey(tree, back, expected, prev(m))){ failed++; }
+        ++it;
+    }
+    if(it != tree.end()){ failed++; }
+    //backward with reverse_iterator, and one step back (to the next larger item) from every item
+    typename Tree::reverse_iterator r = tree.rbegin();
+    for(map<int, int>::reverse_iterator m = expected.rbegin() ; m != expected.rend() ; ++m){
+        if(r == tree.rend() || r->first != m->first){ failed++; break; }
+        typename Tree::reverse_iterator back = r;
+        --back;
+        if(m == expected.rbegin() ? back != tree.rend() : back == tree.rend() || back->first != prev(m)->first){ failed++; }
+        ++r;
+    }
+    if(r != tree.rend()){ failed++; }
+    //neither end steps back
+    typename Tree::iterator end = tree.end();
+    typename Tree::reverse_iterator rend = tree.rend();
+    --end;
+    --rend;
+    if(end != tree.end() || rend != tree.rend()){ failed++; }
+    return failed;
+}
+
+/**
+ * Stepping a reverse_iterator forward and back on 1..5
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int reverseStepTest()
+{
+    int failed = 0;
+    Tree tree;
+    for(int i = 1 ; i <= 5 ; i++){
+        tree.insert(make_pair(i, i));
+    }
+    typename Tree::reverse_iterator r = tree.rbegin();
+    ++r;
+    ++r;
+    --r;
+    if(r == tree.rend() || r->first != 4){ failed++; }
+    r = tree.rbegin();
+    --r;
+    if(r != tree.rend()){ failed++; }
+    typename Tree::iterator it = tree.begin();
+    --it;
+    if(it != tree.end()){ failed++; }
+    //from the smallest item back up to the largest
+    r = tree.rbegin();
+    for(int i = 0 ; i < 4 ; i++){
+        ++r;
+    }
+    for(int key = 1 ; key <= 5 ; key++, --r){
+        if(r == tree.rend() || r->first != key){ failed++; }
+    }
+    if(r != tree.rend()){ failed++; }
+    return failed;
+}
+
+//an AVLTree is balanced and its balance factors and sizes are right, a plain BST keeps neither
+template<class Tree>
+bool nodesOk(const Tree& tree)
+{
+    return tree.isBalanced() && tree.sizesOk() && tree.balancesOk();
+}
+
+template<class Alloc, class NodeT>
+bool nodesOk(const Inspected<BinarySearchTree<int, int, Alloc, NodeT> >&)
+{
+    return true;
+}
+
+/**
+ * try_emplace leaves an existing key's value alone and inserts a missing key, upsert applies
+ * its function to the value in the tree (Value() for a new key) and hands back that value.
+ * Random calls of both against std::map keep the tree balanced with the right sizes
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int upsertTest(int seed)
+{
+    int failed = 0;
+    Tree tree;
+    tree.insert(make_pair(10, 100));
+    pair<typename Tree::iterator, bool> result = tree.try_emplace(10, 200);
+    if(result.second || result.first == tree.end() || result.first->first != 10 || tree.find(10)->second != 100){ failed++; }
+    result = tree.try_emplace(20, 200);
+    if(!result.second || result.first != tree.find(20) || result.first->second != 200 || !tree.rightmostOk()){ failed++; }
+    result = tree.try_emplace(5, 50);
+    if(!result.second || result.first != tree.begin() || result.first->second != 50){ failed++; }
+
+    int& created = tree.upsert(30, [](int& value){ value += 7; });
+    if(created != 7 || tree.find(30)->second != 7 || !tree.rightmostOk()){ failed++; }
+    created = 8;
+    if(tree.find(30)->second != 8){ failed++; }
+    int& updated = tree.upsert(10, [](int& value){ value *= 2; });
+    if(updated != 200 || tree.find(10)->second != 200 || &updated != &tree.find(10)->second){ failed++; }
+
+    mt19937 rng(seed);
+    map<int, int> expected;
+    for(typename Tree::iterator it = tree.begin() ; it != tree.end() ; ++it){
+        expected[it->first] = it->second;
+    }
+    for(int i = 0 ; i < 5000 ; i++){
+        int key = rng() % 2000;
+        if(i % 3 == 0){
+            bool missing = expected.count(key) == 0;
+            result = tree.try_emplace(key, i);
+            expected.insert(make_pair(key, i));
+            if(result.second != missing || result.first->second != expected[key]){ failed++; }
+        } else if(i % 3 == 1){
+            int& value = tree.upsert(key, [i](int& value){ value += i; });
+            expected[key] += i;
+            if(value != expected[key]){ failed++; }
+        } else {
+            tree.remove(key);
+            expected.erase(key);
+        }
+    }
+    if(!sameItems(tree, expected) || !tree.rightmostOk() || !nodesOk(tree)){ failed++; }
+    return failed;
+}
+
+/**
+ * Hinted inserts with the right hint, end(), begin() and a wrong hint, into an empty tree,
+ * and of keys that are already there (at the hint or right before it), against std::map.
+ * Whatever the hint, the key ends up in the right place with the new value
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int hintTest(int seed)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    Tree ascending, descending;
+    map<int, int> expected;
+    for(int i = 0 ; i < 1000 ; i++){
+        ascending.insert(ascending.end(), make_pair(i, i));
+        descending.insert(descending.begin(), make_pair(999 - i, 999 - i));
+        expected[i] = i;
+    }
+    if(!sameItems(ascending, expected) || !sameItems(descending, expected)){ failed++; }
+    if(!nodesOk(ascending) || !nodesOk(descending) || !ascending.rightmostOk() || !descending.rightmostOk()){ failed++; }
+
+    Tree tree;
+    expected.clear();
+    for(int i = 0 ; i < 4000 ; i++){
+        int key = rng() % 3000;
+        typename Tree::iterator hint;
+        switch(i % 5){
+        case 0: hint = tree.upper_bound(key); break;
+        case 1: hint = tree.end(); break;
+        case 2: hint = tree.begin(); break;
+        case 3: hint = tree.lower_bound(rng() % 3000); break;
+        //the key itself when it is there
+        default: hint = tree.lower_bound(key);
+        }
+        typename Tree::iterator it = tree.insert(hint, make_pair(key, i));
+        expected[key] = i;
+        if(it == tree.end() || it->first != key || it->second != i){ failed++; }
+        if(i % 500 == 0 && (!sameItems(tree, expected) || !tree.rightmostOk())){ failed++; }
+    }
+    if(!sameItems(tree, expected) || !nodesOk(tree) || !tree.rightmostOk()){ failed++; }
+
+    //an existing key at the hint, or just before it, only gets the new value
+    int key = expected.begin()->first;
+    typename Tree::iterator it = tree.insert(tree.find(key), make_pair(key, -1));
+    int after = next(expected.begin())->first;
+    typename Tree::iterator it2 = tree.insert(tree.find(after), make_pair(key, -2));
+    expected[key] = -2;
+    if(it != tree.find(key) || it2 != tree.find(key) || it->second != -2 || !sameItems(tree, expected)){ failed++; }
+    int largest = expected.rbegin()->first;
+    tree.insert(tree.end(), make_pair(largest, -3));
+    expected[largest] = -3;
+    if(!sameItems(tree, expected) || !tree.rightmostOk()){ failed++; }
+
+    Tree single;
+    single.insert(single.begin(), make_pair(5, 5));
+    single.insert(single.end(), make_pair(7, 7));
+    single.insert(single.begin(), make_pair(6, 6));
+    map<int, int> three;
+    three[5] = 5;
+    three[6] = 6;
+    three[7] = 7;
+    if(!sameItems(single, three) || !single.rightmostOk()){ failed++; }
+    return failed;
+}
+
+/**
+ * rightmost_ (which insert(end(), ...) appends after) stays the largest node through removes
+ * of the largest key down to an empty tree, clear() and bulk loads
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int rightmostTest()
+{
+    int failed = 0;
+    Tree tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < 200 ; i++){
+        tree.insert(make_pair((i * 37) % 200, i));
+        expected[(i * 37) % 200] = i;
+    }
+    while(!expected.empty()){
+        tree.remove(expected.rbegin()->first);
+        expected.erase(prev(expected.end()));
+        if(!tree.rightmostOk()){ failed++; }
+    }
+    tree.insert(tree.end(), make_pair(3, 3));
+    expected[3] = 3;
+    if(!sameItems(tree, expected) || !tree.rightmostOk()){ failed++; }
+
+    for(int i = 10 ; i < 100 ; i++){
+        tree.insert(make_pair(i, i));
+    }
+    tree.clear();
+    expected.clear();
+    tree.insert(tree.end(), make_pair(1, 1));
+    tree.insert(tree.end(), make_pair(2, 2));
+    expected[1] = 1;
+    expected[2] = 2;
+    if(!sameItems(tree, expected) || !tree.rightmostOk()){ failed++; }
+
+    vector<pair<int, int> > items;
+    for(int i = 0 ; i < 50 ; i++){
+        items.push_back(make_pair(i, i));
+    }
+    tree.buildFromSorted(items.begin(), items.end());
+    tree.insert(tree.end(), make_pair(50, 50));
+    expected = map<int, int>(items.begin(), items.end());
+    expected[50] = 50;
+    if(!sameItems(tree, expected) || !tree.rightmostOk()){ failed++; }
+    return failed;
+}
+
+/**
+ * rightmost_ of both trees after join, split and the set operations, which move subtrees
+ * around instead of inserting. Appending at end() afterwards must still land in order
+ * returns the number of failed checks
+ * */
+template<class Tree>
+int joinSplitRightmostTest(int seed)
+{
+    int failed = 0;
+    mt19937 rng(seed);
+    for(int round = 0 ; round < 40 ; round++){
+        Tree a, c, greater;
+        map<int, int> ma, mc;
+        for(int i = rng() % 300 ; i > 0 ; i--){
+            int key = rng() % 1000;
+            a.insert(make_pair(key, i));
+            ma[key] = i;
+        }
+        for(int i = rng() % 300 ; i > 0 ; i--){
+            int key = 2000 + rng() % 1000;
+            c.insert(make_pair(key, i));
+            mc[key] = i;
+        }
+        a.join(1500, 0, c);
+        ma[1500] = 0;
+        ma.insert(mc.begin(), mc.end());
+        if(!a.rightmostOk() || !c.rightmostOk()){ failed++; }
+
+        int key = rng() % 3200;
+        a.split(key, greater);
+        map<int, int> more(ma.lower_bound(key), ma.end());
+        ma.erase(ma.lower_bound(key), ma.end());
+        if(!a.rightmostOk() || !greater.rightmostOk()){ failed++; }
+        a.insert(a.end(), make_pair(key - 1, -1));
+        ma[key - 1] = -1;
+        greater.insert(greater.end(), make_pair(5000, -1));
+        more[5000] = -1;
+        if(!sameItems(a, ma) || !sameItems(greater, more) || !nodesOk(a) || !nodesOk(greater)){ failed++; }
+
+        //a's keys are all below key, greater's from key up
+        switch(round % 3){
+        case 0:
+            a.unionWith(greater);
+            ma.insert(more.begin(), more.end());
+            break;
+        case 1:
+            a.unionWith(greater);
+            a.intersectWith(greater);
+            ma = more;
+            break;
+        default:
+            a.unionWith(greater);
+            a.subtract(greater);
+        }
+        if(!a.rightmostOk()){ failed++; }
+        a.insert(a.end(), make_pair(9000, 1));
+        ma[9000] = 1;
+        if(!sameItems(a, ma) || !a.rightmostOk()){ failed++; }
+    }
+    return failed;
+}
+
+int main()
+{
+    int failed = 0;
+    failed += clearTest<StringAVL, string>(1) + clearTest<StdStringAVL, string>(2);
+    failed += clearTest<IntAVL, int>(3) + clearTest<StringBST, string>(4);
+    failed += destructorTest<AVLTree<int, Counted> >();
+    failed += destructorTest<AVLTree<int, Counted, allocator<pair<const int, Counted> > > >();
+    failed += destructorTest<BinarySearchTree<int, Counted> >();
+    if(failed != 0){
+        cout << "FAILED: clear and teardown, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "clear and teardown tests passed" << endl;
+    failed = buildTest<IntAVL>(5) + buildTest<StdIntAVL>(6) + buildTest<IntBST>(7);
+    if(failed != 0){
+        cout << "FAILED: buildFromSorted and sortAndBuild, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "bulk load tests passed" << endl;
+    failed = orderStatisticsTest<IntAVL>(8) + orderStatisticsTest<StdIntAVL>(9);
+    if(failed != 0){
+        cout << "FAILED: select, rank and countRange, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "order statistics tests passed" << endl;
+    failed = reverseStepTest<IntAVL>() + reverseStepTest<IntBST>();
+    const int sizes[] = { 0, 1, 2, 10, 1000 };
+    for(int s = 0 ; s < 5 ; s++){
+        failed += lookupTest<IntAVL>(10 + s, sizes[s]) + lookupTest<IntBST>(20 + s, sizes[s]);
+    }
+    if(failed != 0){
+        cout << "FAILED: ordered lookups and iterators, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "ordered lookup tests passed" << endl;
+    failed = upsertTest<IntAVL>(30) + upsertTest<StdIntAVL>(31) + upsertTest<IntBST>(32);
+    if(failed != 0){
+        cout << "FAILED: try_emplace and upsert, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "try_emplace and upsert tests passed" << endl;
+    failed = hintTest<IntAVL>(40) + hintTest<StdIntAVL>(41) + hintTest<IntBST>(42);
+    failed += rightmostTest<IntAVL>() + rightmostTest<StdIntAVL>() + rightmostTest<IntBST>();
+    failed += joinSplitRightmostTest<IntAVL>(43) + joinSplitRightmostTest<StdIntAVL>(44);
+    if(failed != 0){
+        cout << "FAILED: hinted inserts and rightmost_, " << failed << " checks" << endl;
+        return 1;
+    }
+    cout << "hinted insert tests passed" << endl;
+    return 0;
+}
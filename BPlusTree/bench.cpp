@@ -0,0 +1,153 @@
+#include "bplustree.h"
+#include "avlbst.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Every result is one row of a single CSV table, same columns as the AVLTree benchmark
+ * */
+class CsvReport{
+    public:
+        CsvReport(ostream& out) : out(out){
+            out << "suite,structure,n,op,ns_per_op" << endl;
+        }
+        void row(const string& suite, const string& structure, long long n, const string& op, double nsPerOp){
+            out << suite << "," << structure << "," << n << "," << op << "," << nsPerOp << endl;
+        }
+    private:
+        ostream& out;
+};
+
+double nsSince(chrono::steady_clock::time_point start){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+//n distinct keys in random order
+vector<int> makeKeys(int n){
+    vector<int> keys(n);
+    for(int i = 0 ; i < n ; i++){
+        keys[i] = i * 2;
+    }
+    mt19937 rng(104 + n);
+    shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+//the trees remove by key, std::map erases by key
+template<class Tree>
+void removeKey(Tree& tree, int key){
+    tree.remove(key);
+}
+
+void removeKey(map<int, int>& tree, int key){
+    tree.erase(key);
+}
+
+/**
+ * Random inserts, then finds of present and absent keys in another random order, a full in-order scan,
+ * and removing every key in the find order
+ * Tree is BPlusTree, AVLTree or std::map, all have insert(pair)/find/end/begin
+ * */
+template<class Tree>
+void lookupRun(CsvReport& report, const string& structure, int n){
+    vector<int> keys = makeKeys(n);
+    vector<int> probes = makeKeys(n);
+    Tree tree;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        tree.insert(make_pair(keys[i], i));
+    }
+    report.row("lookup", structure, n, "insert", nsSince(start) / n);
+
+    long long found = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.find(probes[i]) != tree.end()){ found++; }
+    }
+    report.row("lookup", structure, n, "find_hit", nsSince(start) / n);
+
+    //odd keys are never inserted
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        if(tree.find(probes[i] + 1) != tree.end()){ found++; }
+    }
+    report.row("lookup", structure, n, "find_miss", nsSince(start) / n);
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for(typename Tree::iterator it = tree.begin() ; it != tree.end() ; ++it){
+        sum += it->second;
+    }
+    report.row("lookup", structure, n, "iterate", nsSince(start) / n);
+    if(found != n || sum != (long long)n * (n-1) / 2){
+        cerr << "ERROR: " << structure << " lost items" << endl;
+    }
+
+    start = chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; i++){
+        removeKey(tree, probes[i]);
+    }
+    report.row("lookup", structure, n, "remove", nsSince(start) / n);
+    if(tree.begin() != tree.end()){
+        cerr << "ERROR: " << structure << " is not empty after removing everything" << endl;
+    }
+}
+
+void usage(){
+    cerr << "usage: ./bench [--min-size N] [--max-size N] [--csv FILE]" << endl
+         << "sizes go from --min-size to --max-size by factors of 10 (default 1000 to 1000000)" << endl;
+}
+
+/**
+ * BPlusTree against AVLTree and std::map: insert, find, in-order iteration and remove,
+ * written as one CSV table to stdout (or --csv FILE)
+ * */
+int main(int argc, char* argv[]){
+    long long minSize = 1000;
+    long long maxSize = 1000000;
+    string csvFile = "";
+    for(int i = 1 ; i < argc ; i += 2){
+        string arg = argv[i];
+        if(i+1 >= argc){
+            usage();
+            return 1;
+        }
+        if(arg == "--min-size"){
+            minSize = atoll(argv[i+1]);
+        } else if(arg == "--max-size"){
+            maxSize = atoll(argv[i+1]);
+        } else if(arg == "--csv"){
+            csvFile = argv[i+1];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if(minSize < 1){ minSize = 1; }
+
+    ofstream file;
+    if(csvFile != ""){
+        file.open(csvFile.c_str());
+        if(!file){
+            cerr << "Could not open " << csvFile << endl;
+            return 1;
+        }
+    }
+    CsvReport report(csvFile != "" ? (ostream&)file : cout);
+
+    for(long long n = minSize ; n <= maxSize ; n *= 10){
+        lookupRun<BPlusTree<int, int> >(report, "bplus", n);
+        lookupRun<AVLTree<int, int> >(report, "avl", n);
+        lookupRun<map<int, int> >(report, "std_map", n);
+    }
+    return 0;
+}
@@ -0,0 +1,797 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <iostream>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+//every node is sized to fit in this many bytes (4 cache lines)
+const std::size_t BPLUS_NODE_BYTES = 256;
+//inner nodes have at least 5 children, so 32 levels is more than any tree in memory reaches
+const int BPLUS_MAX_HEIGHT = 32;
+
+/**
+ * Finds where a key goes among the n sorted keys of a node.
+ * countLess is the number of keys < key (the leaf slot of key), countLessEqual the number of
+ * keys <= key (the child to descend into). Any key type uses a binary search.
+ */
+template <typename Key, bool Integral = std::is_integral<Key>::value>
+struct NodeSearch
+{
+    static int countLess(const Key* keys, int n, int slots, const Key& key);
+    static int countLessEqual(const Key* keys, int n, int slots, const Key& key);
+};
+
+/**
+ * Integer keys are compared all at once: the loop runs over every slot of the node (the slot
+ * count is a multiple of the vector width) and adds up the comparisons without branching, which
+ * the compiler turns into a few SIMD compares. For a node of a few cache lines that beats the
+ * mispredicted branches of a binary search.
+ */
+template <typename Key>
+struct NodeSearch<Key, true>
+{
+    static int countLess(const Key* keys, int n, int slots, const Key& key);
+    static int countLessEqual(const Key* keys, int n, int slots, const Key& key);
+};
+
+/**
+ * An ordered map stored as a B+-tree, with the same interface as BinarySearchTree/AVLTree
+ * (insert, remove, find, begin, end, operator[], erase), so it can replace them.
+ *
+ * A node holds as many keys as fit in BPLUS_NODE_BYTES instead of one, so a lookup touches
+ * a handful of nodes (a few cache lines each) instead of one cache miss per level of a binary
+ * tree. Items live only in the leaves, inner nodes hold separator keys, and the leaves are
+ * linked in key order, so iterating is a walk over arrays.
+ *
+ * Keys and values are kept in separate arrays (the key search only reads keys), so the
+ * iterator hands out a pair of references, std::pair<const Key&, Value&>, instead of a reference
+ * to a stored pair. it->first, it->second and (*it).second = v work as with the other trees.
+ * Key and Value need a default constructor and assignment, the node arrays are built from them.
+ */
+template <typename Key, typename Value>
+class BPlusTree
+{
+private:
+    //rounds a slot count down to a multiple of 8 (and at least 8), so the search loops have no remainder
+    static constexpr int roundSlots(std::size_t n){ return n < 16 ? 8 : (int)(n / 8 * 8); }
+public:
+    //items per leaf: the keys, the values, the two leaf links and the count
+    static constexpr int LEAF_SLOTS = roundSlots((BPLUS_NODE_BYTES - 2 * sizeof(void*) - sizeof(int)) / (sizeof(Key) + sizeof(Value)));
+    //separator keys per inner node, which has one child more than that
+    static constexpr int INNER_SLOTS = roundSlots((BPLUS_NODE_BYTES - sizeof(void*) - sizeof(int)) / (sizeof(Key) + sizeof(void*)));
+
+    typedef std::pair<const Key&, Value&> reference;
+
+    BPlusTree();
+    ~BPlusTree();
+    //the tree owns its nodes, a copy would share and then free them twice
+    BPlusTree(const BPlusTree& other) = delete;
+    BPlusTree& operator=(const BPlusTree& other) = delete;
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void insert(Key k, Value v);
+    void remove(const Key& key);
+    void clear();
+    //checks the B+-tree invariants: all leaves at the same depth, nodes at least half full, keys in order
+    bool isBalanced() const;
+    void print() const;
+    bool empty() const;
+
+private:
+    struct Leaf
+    {
+        Leaf();
+        int count;
+        Key keys[LEAF_SLOTS];
+        Value values[LEAF_SLOTS];
+        Leaf* prev;
+        Leaf* next;
+    };
+    //children[i] holds the keys in [keys[i-1], keys[i]), count is the number of keys
+    struct Inner
+    {
+        Inner();
+        int count;
+        Key keys[INNER_SLOTS];
+        void* children[INNER_SLOTS + 1];
+    };
+    //a node and the child taken from it, one per level on the way down
+    struct PathStep
+    {
+        Inner* node;
+        int child;
+    };
+
+public:
+    /**
+    * An iterator over the items in key order, a leaf and a slot in it.
+    */
+    class iterator
+    {
+    public:
+        //what operator-> hands out: a pair of references that lives as long as the expression
+        class pointer
+        {
+        public:
+            pointer(reference item);
+            reference* operator->();
+        private:
+            reference item_;
+        };
+
+        iterator();
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class BPlusTree<Key, Value>;
+        iterator(Leaf* leaf, int index);
+        Leaf* leaf_;
+        int index_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+
+    //inserts a default value if the key is missing, like std::map
+    Value& operator[](Key k);
+    void erase(iterator it);
+    void erase(Key k);
+
+private:
+    //fills path (if not NULL) with the height_ - 1 inner nodes from the root down and returns the leaf that may hold key
+    Leaf* findLeaf(const Key& key, PathStep* path) const;
+    //adds separator/right child to the inner node path[level] after a split below it
+    void insertIntoParent(PathStep* path, int level, const Key& separator, void* right);
+    //fixes path[level].node (or the root) after it lost a child
+    void fixInner(PathStep* path, int level);
+    void freeSubtree(void* node, int height);
+    bool checkSubtree(void* node, int height, const Key* low, const Key* high, bool isRoot, Leaf*& lastLeaf) const;
+
+    void* root_;
+    //levels of nodes, 1 if the root is a leaf, 0 if empty
+    int height_;
+};
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for NodeSearch.
+  -------------------------------------------------
+*/
+
+template <typename Key, bool Integral>
+int NodeSearch<Key, Integral>::countLess(const Key* keys, int n, int, const Key& key)
+{
+    return std::lower_bound(keys, keys + n, key) - keys;
+}
+
+template <typename Key, bool Integral>
+int NodeSearch<Key, Integral>::countLessEqual(const Key* keys, int n, int, const Key& key)
+{
+    return std::upper_bound(keys, keys + n, key) - keys;
+}
+
+/**
+ * Slots past n are compared too (they are always initialized), and masked out.
+ */
+template <typename Key>
+int NodeSearch<Key, true>::countLess(const Key* keys, int n, int slots, const Key& key)
+{
+    int count = 0;
+    for(int i = 0 ; i < slots ; i++){
+        count += (i < n) & (keys[i] < key);
+    }
+    return count;
+}
+
+template <typename Key>
+int NodeSearch<Key, true>::countLessEqual(const Key* keys, int n, int slots, const Key& key)
+{
+    int count = 0;
+    for(int i = 0 ; i < slots ; i++){
+        count += (i < n) & (keys[i] <= key);
+    }
+    return count;
+}
+
+/*
+  -------------------------------------------------
+  End implementations for NodeSearch.
+  -------------------------------------------------
+*/
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for the BPlusTree::iterator class.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::iterator::pointer::pointer(reference item) :
+    item_(item)
+{
+
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::reference* BPlusTree<Key, Value>::iterator::pointer::operator->()
+{
+    return &item_;
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::iterator::iterator() :
+    leaf_(NULL),
+    index_(0)
+{
+
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::iterator::iterator(Leaf* leaf, int index) :
+    leaf_(leaf),
+    index_(index)
+{
+
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::reference BPlusTree<Key, Value>::iterator::operator*() const
+{
+    return reference(leaf_->keys[index_], leaf_->values[index_]);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator::pointer BPlusTree<Key, Value>::iterator::operator->() const
+{
+    return pointer(**this);
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::iterator::operator==(const iterator& rhs) const
+{
+    return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::iterator::operator!=(const iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+ * Next slot of the leaf, or the first slot of the next leaf. end() is (NULL, 0)
+ */
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator& BPlusTree<Key, Value>::iterator::operator++()
+{
+    index_++;
+    if(index_ == leaf_->count){
+        leaf_ = leaf_->next;
+        index_ = 0;
+    }
+    return *this;
+}
+
+/*
+  -------------------------------------------------
+  End implementations for the BPlusTree::iterator class.
+  -------------------------------------------------
+*/
+
+
+/*
+  -------------------------------------------------
+  Begin implementations for the BPlusTree class.
+  -------------------------------------------------
+*/
+
+//unused slots are value initialized, the integer key search reads them
+template<class Key, class Value>
+BPlusTree<Key, Value>::Leaf::Leaf() :
+    count(0),
+    keys(),
+    values(),
+    prev(NULL),
+    next(NULL)
+{
+
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::Inner::Inner() :
+    count(0),
+    keys(),
+    children()
+{
+
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::BPlusTree() :
+    root_(NULL),
+    height_(0)
+{
+
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::~BPlusTree()
+{
+    clear();
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::empty() const
+{
+    return root_ == NULL;
+}
+
+/**
+ * Frees every node, level by level down from the root
+ * runtime = O(n / LEAF_SLOTS)
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::clear()
+{
+    freeSubtree(root_, height_);
+    root_ = NULL;
+    height_ = 0;
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::freeSubtree(void* node, int height)
+{
+    if(node == NULL){
+        return;
+    }
+    if(height == 1){
+        delete (Leaf*)node;
+        return;
+    }
+    Inner* inner = (Inner*)node;
+    for(int i = 0 ; i <= inner->count ; i++){
+        freeSubtree(inner->children[i], height - 1);
+    }
+    delete inner;
+}
+
+/**
+ * Walks down from the root, one node search per level
+ * runtime = O(log n) node searches, each over one node of a few cache lines
+ */
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::Leaf* BPlusTree<Key, Value>::findLeaf(const Key& key, PathStep* path) const
+{
+    void* node = root_;
+    for(int level = 0 ; level < height_ - 1 ; level++){
+        Inner* inner = (Inner*)node;
+        int child = NodeSearch<Key>::countLessEqual(inner->keys, inner->count, INNER_SLOTS, key);
+        if(path != NULL){
+            path[level].node = inner;
+            path[level].child = child;
+        }
+        node = inner->children[child];
+    }
+    return (Leaf*)node;
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::find(const Key& key) const
+{
+    if(empty()){
+        return end();
+    }
+    Leaf* leaf = findLeaf(key, NULL);
+    int pos = NodeSearch<Key>::countLess(leaf->keys, leaf->count, LEAF_SLOTS, key);
+    if(pos < leaf->count && !(key < leaf->keys[pos])){
+        return iterator(leaf, pos);
+    }
+    return end();
+}
+
+/**
+ * The leftmost leaf, the first item
+ */
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::begin() const
+{
+    if(empty()){
+        return end();
+    }
+    void* node = root_;
+    for(int level = height_ ; level > 1 ; level--){
+        node = ((Inner*)node)->children[0];
+    }
+    return iterator((Leaf*)node, 0);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::end() const
+{
+    return iterator(NULL, 0);
+}
+
+template<class Key, class Value>
+Value& BPlusTree<Key, Value>::operator[](Key k)
+{
+    iterator it = find(k);
+    if(it == end()){
+        insert(k, Value());
+        it = find(k);
+    }
+    return it.leaf_->values[it.index_];
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::erase(iterator it)
+{
+    remove(it.leaf_->keys[it.index_]);
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::erase(Key k)
+{
+    remove(k);
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::insert(Key k, Value v)
+{
+    insert(std::pair<const Key, Value>(k, v));
+}
+
+/**
+ * Puts the item in its leaf, overwriting the value if the key is already there.
+ * A full leaf is split in two halves and the first key of the right half goes up to the
+ * parent, which may split in turn. A split root makes the tree one level taller.
+ * runtime = O(log n), plus O(LEAF_SLOTS) to shift items within a node
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    const Key& key = keyValuePair.first;
+    if(empty()){
+        Leaf* first = new Leaf();
+        first->keys[0] = key;
+        first->values[0] = keyValuePair.second;
+        first->count = 1;
+        root_ = first;
+        height_ = 1;
+        return;
+    }
+    PathStep path[BPLUS_MAX_HEIGHT];
+    Leaf* leaf = findLeaf(key, path);
+    int pos = NodeSearch<Key>::countLess(leaf->keys, leaf->count, LEAF_SLOTS, key);
+    //if equal, then overwrite the previous value with new
+    if(pos < leaf->count && !(key < leaf->keys[pos])){
+        leaf->values[pos] = keyValuePair.second;
+        return;
+    }
+    if(leaf->count < LEAF_SLOTS){
+        std::copy_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::copy_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[pos] = key;
+        leaf->values[pos] = keyValuePair.second;
+        leaf->count++;
+        return;
+    }
+
+    //split: the left half stays, the right half (plus the new item, if it goes there) moves out
+    Leaf* right = new Leaf();
+    int leftCount = (LEAF_SLOTS + 1) / 2;
+    bool goesLeft = pos < leftCount;
+    //when the item goes left, one more of the old items moves right to make room
+    int moveFrom = goesLeft ? leftCount - 1 : leftCount;
+    std::copy(leaf->keys + moveFrom, leaf->keys + LEAF_SLOTS, right->keys);
+    std::copy(leaf->values + moveFrom, leaf->values + LEAF_SLOTS, right->values);
+    right->count = LEAF_SLOTS - moveFrom;
+    leaf->count = moveFrom;
+    Leaf* target = goesLeft ? leaf : right;
+    int at = goesLeft ? pos : pos - moveFrom;
+    std::copy_backward(target->keys + at, target->keys + target->count, target->keys + target->count + 1);
+    std::copy_backward(target->values + at, target->values + target->count, target->values + target->count + 1);
+    target->keys[at] = key;
+    target->values[at] = keyValuePair.second;
+    target->count++;
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if(leaf->next != NULL){
+        leaf->next->prev = right;
+    }
+    leaf->next = right;
+    insertIntoParent(path, height_ - 2, right->keys[0], right);
+}
+
+/**
+ * Adds separator and the node right of it to path[level].node, right after the child
+ * that was split. A full inner node is split around its middle key, which moves up.
+ * level -1 means the root itself was split
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::insertIntoParent(PathStep* path, int level, const Key& separator, void* right)
+{
+    if(level < 0){
+        Inner* newRoot = new Inner();
+        newRoot->keys[0] = separator;
+        newRoot->children[0] = root_;
+        newRoot->children[1] = right;
+        newRoot->count = 1;
+        root_ = newRoot;
+        height_++;
+        return;
+    }
+    Inner* node = path[level].node;
+    int pos = path[level].child;
+    if(node->count < INNER_SLOTS){
+        std::copy_backward(node->keys + pos, node->keys + node->count, node->keys + node->count + 1);
+        std::copy_backward(node->children + pos + 1, node->children + node->count + 1, node->children + node->count + 2);
+        node->keys[pos] = separator;
+        node->children[pos + 1] = right;
+        node->count++;
+        return;
+    }
+
+    //full: lay out all keys and children with the new one in place, then cut at the middle key
+    Key keys[INNER_SLOTS + 1];
+    void* children[INNER_SLOTS + 2];
+    std::copy(node->keys, node->keys + pos, keys);
+    keys[pos] = separator;
+    std::copy(node->keys + pos, node->keys + INNER_SLOTS, keys + pos + 1);
+    std::copy(node->children, node->children + pos + 1, children);
+    children[pos + 1] = right;
+    std::copy(node->children + pos + 1, node->children + INNER_SLOTS + 1, children + pos + 2);
+
+    int middle = (INNER_SLOTS + 1) / 2;
+    Inner* sibling = new Inner();
+    std::copy(keys, keys + middle, node->keys);
+    std::copy(children, children + middle + 1, node->children);
+    node->count = middle;
+    sibling->count = INNER_SLOTS - middle;
+    std::copy(keys + middle + 1, keys + INNER_SLOTS + 1, sibling->keys);
+    std::copy(children + middle + 1, children + INNER_SLOTS + 2, sibling->children);
+    insertIntoParent(path, level - 1, keys[middle], sibling);
+}
+
+/**
+ * Removes the item with the key, if there is one.
+ * A leaf left less than half full takes an item from a sibling that can spare one, otherwise
+ * it is merged with the sibling. A merge takes a key out of the parent, which is fixed the same
+ * way, up to the root. An inner root left with one child is dropped and the tree gets shorter.
+ * Separator keys of removed items can stay in the inner nodes, they still split the keys right.
+ * runtime = O(log n), plus O(LEAF_SLOTS) to shift items within a node
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::remove(const Key& key)
+{
+    if(empty()){ return; }
+    PathStep path[BPLUS_MAX_HEIGHT];
+    Leaf* leaf = findLeaf(key, path);
+    int pos = NodeSearch<Key>::countLess(leaf->keys, leaf->count, LEAF_SLOTS, key);
+    if(pos == leaf->count || key < leaf->keys[pos]){ return; }
+    std::copy(leaf->keys + pos + 1, leaf->keys + leaf->count, leaf->keys + pos);
+    std::copy(leaf->values + pos + 1, leaf->values + leaf->count, leaf->values + pos);
+    leaf->count--;
+
+    const int minCount = LEAF_SLOTS / 2;
+    if(height_ == 1){
+        //the root is a leaf, it may have any number of items
+        if(leaf->count == 0){
+            delete leaf;
+            root_ = NULL;
+            height_ = 0;
+        }
+        return;
+    }
+    if(leaf->count >= minCount){ return; }
+
+    Inner* parent = path[height_ - 2].node;
+    int child = path[height_ - 2].child;
+    Leaf* left = child > 0 ? (Leaf*)parent->children[child - 1] : NULL;
+    Leaf* right = child < parent->count ? (Leaf*)parent->children[child + 1] : NULL;
+    if(left != NULL && left->count > minCount){
+        //borrow the left sibling's last item
+        std::copy_backward(leaf->keys, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::copy_backward(leaf->values, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[0] = left->keys[left->count - 1];
+        leaf->values[0] = left->values[left->count - 1];
+        leaf->count++;
+        left->count--;
+        parent->keys[child - 1] = leaf->keys[0];
+        return;
+    }
+    if(right != NULL && right->count > minCount){
+        //borrow the right sibling's first item
+        leaf->keys[leaf->count] = right->keys[0];
+        leaf->values[leaf->count] = right->values[0];
+        leaf->count++;
+        std::copy(right->keys + 1, right->keys + right->count, right->keys);
+        std::copy(right->values + 1, right->values + right->count, right->values);
+        right->count--;
+        parent->keys[child] = right->keys[0];
+        return;
+    }
+    //merge the right one of the pair into the left one, together they fit in a leaf
+    int removed = child;
+    if(left != NULL){
+        right = leaf;
+        leaf = left;
+        removed = child - 1;
+    }
+    std::copy(right->keys, right->keys + right->count, leaf->keys + leaf->count);
+    std::copy(right->values, right->values + right->count, leaf->values + leaf->count);
+    leaf->count += right->count;
+    leaf->next = right->next;
+    if(right->next != NULL){
+        right->next->prev = leaf;
+    }
+    delete right;
+    //the separator between the pair and the right child go
+    std::copy(parent->keys + removed + 1, parent->keys + parent->count, parent->keys + removed);
+    std::copy(parent->children + removed + 2, parent->children + parent->count + 1, parent->children + removed + 1);
+    parent->count--;
+    fixInner(path, height_ - 2);
+}
+
+/**
+ * path[level].node just lost a key and a child. The root only has to keep one child (if it has
+ * a single one, that child becomes the root), any other inner node is refilled from a sibling or
+ * merged with it through the separator key above them, which may leave the parent short in turn
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::fixInner(PathStep* path, int level)
+{
+    const int minCount = INNER_SLOTS / 2;
+    while(true){
+        Inner* node = path[level].node;
+        if(level == 0){
+            if(node->count == 0){
+                root_ = node->children[0];
+                height_--;
+                delete node;
+            }
+            return;
+        }
+        if(node->count >= minCount){ return; }
+
+        Inner* parent = path[level - 1].node;
+        int child = path[level - 1].child;
+        Inner* left = child > 0 ? (Inner*)parent->children[child - 1] : NULL;
+        Inner* right = child < parent->count ? (Inner*)parent->children[child + 1] : NULL;
+        if(left != NULL && left->count > minCount){
+            //rotate right: the separator comes down in front, left's last key goes up
+            std::copy_backward(node->keys, node->keys + node->count, node->keys + node->count + 1);
+            std::copy_backward(node->children, node->children + node->count + 1, node->children + node->count + 2);
+            node->keys[0] = parent->keys[child - 1];
+            node->children[0] = left->children[left->count];
+            node->count++;
+            parent->keys[child - 1] = left->keys[left->count - 1];
+            left->count--;
+            return;
+        }
+        if(right != NULL && right->count > minCount){
+            //rotate left: the separator comes down at the end, right's first key goes up
+            node->keys[node->count] = parent->keys[child];
+            node->children[node->count + 1] = right->children[0];
+            node->count++;
+            parent->keys[child] = right->keys[0];
+            std::copy(right->keys + 1, right->keys + right->count, right->keys);
+            std::copy(right->children + 1, right->children + right->count + 1, right->children);
+            right->count--;
+            return;
+        }
+        //merge the right one of the pair into the left one, with the separator between them
+        int removed = child;
+        if(left != NULL){
+            right = node;
+            node = left;
+            removed = child - 1;
+        }
+        node->keys[node->count] = parent->keys[removed];
+        std::copy(right->keys, right->keys + right->count, node->keys + node->count + 1);
+        std::copy(right->children, right->children + right->count + 1, node->children + node->count + 1);
+        node->count += right->count + 1;
+        delete right;
+        std::copy(parent->keys + removed + 1, parent->keys + parent->count, parent->keys + removed);
+        std::copy(parent->children + removed + 2, parent->children + parent->count + 1, parent->children + removed + 1);
+        parent->count--;
+        level--;
+    }
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::isBalanced() const
+{
+    if(empty()){
+        return true;
+    }
+    Leaf* lastLeaf = NULL;
+    if(!checkSubtree(root_, height_, NULL, NULL, true, lastLeaf)){
+        return false;
+    }
+    return lastLeaf->next == NULL;
+}
+
+/**
+ * Helper function for isBalanced(): every key of node must be in [low, high) (NULL for no bound)
+ * Leaves are visited in order, lastLeaf is the one before, to check the leaf links
+ * */
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::checkSubtree(void* node, int height, const Key* low, const Key* high, bool isRoot, Leaf*& lastLeaf) const
+{
+    if(height == 1){
+        Leaf* leaf = (Leaf*)node;
+        if(leaf->count < (isRoot ? 1 : LEAF_SLOTS / 2) || leaf->count > LEAF_SLOTS){ return false; }
+        for(int i = 0 ; i < leaf->count ; i++){
+            if(i > 0 && !(leaf->keys[i - 1] < leaf->keys[i])){ return false; }
+            if((low != NULL && leaf->keys[i] < *low) || (high != NULL && !(leaf->keys[i] < *high))){ return false; }
+        }
+        if(leaf->prev != lastLeaf || (lastLeaf != NULL && lastLeaf->next != leaf)){ return false; }
+        lastLeaf = leaf;
+        return true;
+    }
+    Inner* inner = (Inner*)node;
+    if(inner->count < (isRoot ? 1 : INNER_SLOTS / 2) || inner->count > INNER_SLOTS){ return false; }
+    for(int i = 0 ; i <= inner->count ; i++){
+        if(i > 0 && i < inner->count && !(inner->keys[i - 1] < inner->keys[i])){ return false; }
+        const Key* childLow = i == 0 ? low : &inner->keys[i - 1];
+        const Key* childHigh = i == inner->count ? high : &inner->keys[i];
+        if(!checkSubtree(inner->children[i], height - 1, childLow, childHigh, false, lastLeaf)){ return false; }
+    }
+    return true;
+}
+
+/**
+ * Prints one line per level, nodes as [k1 k2 ...] with the keys they hold
+ */
+template<class Key, class Value>
+void BPlusTree<Key, Value>::print() const
+{
+    if(empty()){
+        std::cout << "[empty]" << std::endl;
+        return;
+    }
+    std::vector<void*> level(1, root_);
+    for(int h = height_ ; h >= 1 ; h--){
+        std::vector<void*> next;
+        for(unsigned int i = 0 ; i < level.size() ; i++){
+            std::cout << "[";
+            if(h == 1){
+                Leaf* leaf = (Leaf*)level[i];
+                for(int j = 0 ; j < leaf->count ; j++){
+                    std::cout << (j > 0 ? " " : "") << leaf->keys[j];
+                }
+            } else {
+                Inner* inner = (Inner*)level[i];
+                for(int j = 0 ; j < inner->count ; j++){
+                    std::cout << (j > 0 ? " " : "") << inner->keys[j];
+                }
+                next.insert(next.end(), inner->children, inner->children + inner->count + 1);
+            }
+            std::cout << "] ";
+        }
+        std::cout << std::endl;
+        level.swap(next);
+    }
+}
+
+/*
+  -------------------------------------------------
+  End implementations for the BPlusTree class.
+  -------------------------------------------------
+*/
+
+#endif
@@ -0,0 +1,120 @@
+#include "bplustree.h"
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int intKey(int x){
+    return x;
+}
+
+string stringKey(int x){
+    return "key_" + to_string(x);
+}
+
+/**
+ * Tree and std::map hold exactly the same items, in the same order
+ * */
+template<class K>
+bool sameItems(BPlusTree<K, int>& tree, map<K, int>& expected){
+    typename BPlusTree<K, int>::iterator it = tree.begin();
+    for(typename map<K, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+        if(it == tree.end() || it->first != m->first || it->second != m->second){
+            return false;
+        }
+        ++it;
+    }
+    return it == tree.end();
+}
+
+/**
+ * Random inserts, overwrites and removes over a small key range, so leaves and inner nodes
+ * split, borrow and merge all the time, checked against std::map
+ * returns the number of failed checks
+ * */
+template<class K>
+int randomTest(K (*makeKey)(int), int ops, int range){
+    int failed = 0;
+    mt19937 rng(2024 + range);
+    BPlusTree<K, int> tree;
+    map<K, int> expected;
+    for(int i = 0 ; i < ops ; i++){
+        K key = makeKey(rng() % range);
+        int op = rng() % 5;
+        if(op < 2){
+            tree.remove(key);
+            expected.erase(key);
+        } else if(op < 4){
+            int value = rng();
+            tree.insert(make_pair(key, value));
+            expected[key] = value;
+        } else {
+            typename BPlusTree<K, int>::iterator found = tree.find(key);
+            if((found == tree.end()) != (expected.find(key) == expected.end())){ failed++; }
+            if(found != tree.end() && found->second != expected[key]){ failed++; }
+        }
+        if(i % 1000 == 0 && !tree.isBalanced()){ failed++; }
+    }
+    if(!tree.isBalanced() || !sameItems(tree, expected)){ failed++; }
+
+    //remove everything in key order, the tree shrinks back to nothing
+    for(typename map<K, int>::iterator m = expected.begin() ; m != expected.end() ; ++m){
+        tree.remove(m->first);
+    }
+    if(!tree.empty() || !tree.isBalanced()){ failed++; }
+    return failed;
+}
+
+/**
+ * operator[], erase and sequential inserts (which always split the last leaf)
+ * */
+int interfaceTest(){
+    int failed = 0;
+    BPlusTree<int, int> tree;
+    map<int, int> expected;
+    for(int i = 0 ; i < 10000 ; i++){
+        tree[i] = i * 3;
+        expected[i] = i * 3;
+    }
+    tree[5] += 1;
+    expected[5] += 1;
+    //missing keys are inserted with a default value
+    if(tree[-1] != 0){ failed++; }
+    expected[-1] = 0;
+    tree.erase(tree.find(100));
+    expected.erase(100);
+    tree.erase(200);
+    expected.erase(200);
+    (*tree.find(300)).second = 7;
+    expected[300] = 7;
+    if(!tree.isBalanced() || !sameItems(tree, expected)){ failed++; }
+    for(int i = 9999 ; i >= 0 ; i -= 2){
+        tree.remove(i);
+        expected.erase(i);
+    }
+    if(!tree.isBalanced() || !sameItems(tree, expected)){ failed++; }
+    tree.clear();
+    if(!tree.empty() || tree.begin() != tree.end()){ failed++; }
+    return failed;
+}
+
+int main(){
+    if(interfaceTest() != 0){
+        cout << "FAILED: interface test" << endl;
+        return 1;
+    }
+    cout << "interface test passed" << endl;
+    if(randomTest<int>(intKey, 300000, 5000) != 0 || randomTest<int>(intKey, 100000, 300) != 0){
+        cout << "FAILED: random int key test" << endl;
+        return 1;
+    }
+    cout << "random int key test passed" << endl;
+    if(randomTest<string>(stringKey, 100000, 3000) != 0){
+        cout << "FAILED: random string key test" << endl;
+        return 1;
+    }
+    cout << "random string key test passed" << endl;
+    return 0;
+}
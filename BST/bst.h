@@ -5,22 +5,33 @@
 #include <exception>
 #include <cstdlib>
 #include <utility>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include "poolallocator.h"
 
 
 #define DEBUG 0
 /**
- * A templated class for a Node in a search tree.
- * The getters for parent/left/right are virtual so
- * that they can be overridden for future kinds of
- * search trees, such as Red Black trees, Splay trees,
- * and AVL trees.
+ * The parts every node of a search tree has: the item and the parent/left/right links.
+ * NodeT is the node class deriving from this one (CRTP), so the links are typed
+ * pointers to the real node type. Node subclasses such as AVLNode get correctly typed
+ * getParent/getLeft/getRight without virtual functions: there is no vtable pointer in
+ * the nodes and every step of a search or rotation is an inlined load.
+ *
+ * Nodes are at least pointer aligned, so the two low bits of a real parent pointer
+ * are always 0. The parent link is stored as an integer and derived nodes may keep
+ * two bits of their own there (AVLNode keeps its balance factor in them).
  */
-template <typename Key, typename Value>
-class Node
+template <typename Key, typename Value, typename NodeT>
+class BasicNode
 {
 public:
-    Node(const Key& key, const Value& value, Node<Key, Value>* parent);
-    virtual ~Node();
+    BasicNode(const Key& key, const Value& value, NodeT* parent);
 
     const std::pair<const Key, Value>& getItem() const;
     std::pair<const Key, Value>& getItem();
@@ -28,20 +39,37 @@ public:
     const Value& getValue() const;
     Value& getValue();
 
-    virtual Node<Key, Value>* getParent() const;
-    virtual Node<Key, Value>* getLeft() const;
-    virtual Node<Key, Value>* getRight() const;
+    NodeT* getParent() const;
+    NodeT* getLeft() const;
+    NodeT* getRight() const;
 
-    void setParent(Node<Key, Value>* parent);
-    void setLeft(Node<Key, Value>* left);
-    void setRight(Node<Key, Value>* right);
+    void setParent(NodeT* parent);
+    void setLeft(NodeT* left);
+    void setRight(NodeT* right);
     void setValue(const Value &value);
 
 protected:
+    //the two bits stored in the parent link, 0 to 3
+    unsigned int getTag() const;
+    void setTag(unsigned int tag);
+
     std::pair<const Key, Value> item_;
-    Node<Key, Value>* parent_;
-    Node<Key, Value>* left_;
-    Node<Key, Value>* right_;
+    //parent pointer | tag
+    std::uintptr_t parent_;
+    NodeT* left_;
+    NodeT* right_;
+};
+
+/**
+ * A templated class for a Node in a plain binary search tree.
+ * Other kinds of search trees (AVL, Red Black, Splay trees) derive their own
+ * node type from BasicNode and pass it to BinarySearchTree as NodeT.
+ */
+template <typename Key, typename Value>
+class Node : public BasicNode<Key, Value, Node<Key, Value> >
+{
+public:
+    Node(const Key& key, const Value& value, Node<Key, Value>* parent);
 };
 
 /*
@@ -52,24 +80,22 @@ protected:
 
 /**
 * Explicit constructor for a node.
+* The destructor is the implicit one: the pointers inside of a node are only used as
+* references to existing nodes, which the BinarySearchTree frees.
 */
-template<typename Key, typename Value>
-Node<Key, Value>::Node(const Key& key, const Value& value, Node<Key, Value>* parent) :
+template<typename Key, typename Value, typename NodeT>
+BasicNode<Key, Value, NodeT>::BasicNode(const Key& key, const Value& value, NodeT* parent) :
     item_(key, value),
-    parent_(parent),
+    parent_((std::uintptr_t)parent),
     left_(NULL),
     right_(NULL)
 {
-
+    static_assert(alignof(BasicNode<Key, Value, NodeT>) >= 4, "the parent link needs two free low bits");
 }
 
-/**
-* Destructor, which does not need to do anything since the pointers inside of a node
-* are only used as references to existing nodes. The nodes pointed to by parent/left/right
-* are freed within the deleteAll() helper method in the BinarySearchTree.
-*/
 template<typename Key, typename Value>
-Node<Key, Value>::~Node()
+Node<Key, Value>::Node(const Key& key, const Value& value, Node<Key, Value>* parent) :
+    BasicNode<Key, Value, Node<Key, Value> >(key, value, parent)
 {
 
 }
@@ -77,8 +103,8 @@ Node<Key, Value>::~Node()
 /**
 * A const getter for the item.
 */
-template<typename Key, typename Value>
-const std::pair<const Key, Value>& Node<Key, Value>::getItem() const
+template<typename Key, typename Value, typename NodeT>
+const std::pair<const Key, Value>& BasicNode<Key, Value, NodeT>::getItem() const
 {
     return item_;
 }
@@ -86,8 +112,8 @@ const std::pair<const Key, Value>& Node<Key, Value>::getItem() const
 /**
 * A non-const getter for the item.
 */
-template<typename Key, typename Value>
-std::pair<const Key, Value>& Node<Key, Value>::getItem()
+template<typename Key, typename Value, typename NodeT>
+std::pair<const Key, Value>& BasicNode<Key, Value, NodeT>::getItem()
 {
     return item_;
 }
@@ -95,8 +121,8 @@ std::pair<const Key, Value>& Node<Key, Value>::getItem()
 /**
 * A const getter for the key.
 */
-template<typename Key, typename Value>
-const Key& Node<Key, Value>::getKey() const
+template<typename Key, typename Value, typename NodeT>
+const Key& BasicNode<Key, Value, NodeT>::getKey() const
 {
     return item_.first;
 }
@@ -104,8 +130,8 @@ const Key& Node<Key, Value>::getKey() const
 /**
 * A const getter for the value.
 */
-template<typename Key, typename Value>
-const Value& Node<Key, Value>::getValue() const
+template<typename Key, typename Value, typename NodeT>
+const Value& BasicNode<Key, Value, NodeT>::getValue() const
 {
     return item_.second;
 }
@@ -113,53 +139,71 @@ const Value& Node<Key, Value>::getValue() const
 /**
 * A non-const getter for the value.
 */
-template<typename Key, typename Value>
-Value& Node<Key, Value>::getValue()
+template<typename Key, typename Value, typename NodeT>
+Value& BasicNode<Key, Value, NodeT>::getValue()
 {
     return item_.second;
 }
 
 /**
-* An implementation of the virtual function for retreiving the parent.
+* A getter for the parent, already typed as the real node type.
 */
-template<typename Key, typename Value>
-Node<Key, Value>* Node<Key, Value>::getParent() const
+template<typename Key, typename Value, typename NodeT>
+NodeT* BasicNode<Key, Value, NodeT>::getParent() const
 {
-    return parent_;
+    return (NodeT*)(parent_ & ~(std::uintptr_t)3);
 }
 
 /**
-* An implementation of the virtual function for retreiving the left child.
+* A getter for the left child.
 */
-template<typename Key, typename Value>
-Node<Key, Value>* Node<Key, Value>::getLeft() const
+template<typename Key, typename Value, typename NodeT>
+NodeT* BasicNode<Key, Value, NodeT>::getLeft() const
 {
     return left_;
 }
 
 /**
-* An implementation of the virtual function for retreiving the right child.
+* A getter for the right child.
 */
-template<typename Key, typename Value>
-Node<Key, Value>* Node<Key, Value>::getRight() const
+template<typename Key, typename Value, typename NodeT>
+NodeT* BasicNode<Key, Value, NodeT>::getRight() const
 {
     return right_;
 }
 
 /**
-* A setter for setting the parent of a node.
+* A setter for setting the parent of a node. The tag bits are kept.
 */
-template<typename Key, typename Value>
-void Node<Key, Value>::setParent(Node<Key, Value>* parent)
+template<typename Key, typename Value, typename NodeT>
+void BasicNode<Key, Value, NodeT>::setParent(NodeT* parent)
 {
-    parent_ = parent;
+    parent_ = (std::uintptr_t)parent | (parent_ & 3);
+}
+
+/**
+* A getter for the two tag bits kept in the parent link.
+*/
+template<typename Key, typename Value, typename NodeT>
+unsigned int BasicNode<Key, Value, NodeT>::getTag() const
+{
+    return parent_ & 3;
+}
+
+/**
+* A setter for the two tag bits kept in the parent link.
+*/
+template<typename Key, typename Value, typename NodeT>
+void BasicNode<Key, Value, NodeT>::setTag(unsigned int tag)
+{
+    parent_ = (parent_ & ~(std::uintptr_t)3) | (tag & 3);
 }
 
 /**
 * A setter for setting the left child of a node.
 */
-template<typename Key, typename Value>
-void Node<Key, Value>::setLeft(Node<Key, Value>* left)
+template<typename Key, typename Value, typename NodeT>
+void BasicNode<Key, Value, NodeT>::setLeft(NodeT* left)
 {
     left_ = left;
 }
@@ -167,8 +211,8 @@ void Node<Key, Value>::setLeft(Node<Key, Value>* left)
 /**
 * A setter for setting the right child of a node.
 */
-template<typename Key, typename Value>
-void Node<Key, Value>::setRight(Node<Key, Value>* right)
+template<typename Key, typename Value, typename NodeT>
+void BasicNode<Key, Value, NodeT>::setRight(NodeT* right)
 {
     right_ = right;
 }
@@ -176,8 +220,8 @@ void Node<Key, Value>::setRight(Node<Key, Value>* right)
 /**
 * A setter for the value of a node.
 */
-template<typename Key, typename Value>
-void Node<Key, Value>::setValue(const Value& value)
+template<typename Key, typename Value, typename NodeT>
+void BasicNode<Key, Value, NodeT>::setValue(const Value& value)
 {
     item_.second = value;
 }
@@ -190,8 +234,12 @@ void Node<Key, Value>::setValue(const Value& value)
 
 /**
 * A templated unbalanced binary search tree.
+* Nodes are allocated with Alloc rebound to the node type. The default PoolAllocator
+* carves them out of large chunks and frees them all at once when the tree is cleared.
+* NodeT is the node type (derived from BasicNode), e.g. AVLTree uses AVLNode.
 */
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Alloc = PoolAllocator<std::pair<const Key, Value> >,
+          typename NodeT = Node<Key, Value> >
 class BinarySearchTree
 {
 public:
@@ -203,6 +251,12 @@ public:
     //added for debugging purposes ^^
     virtual void remove(const Key& key); //TODO
     void clear(); //TODO
+    //replaces the contents with the items of a range sorted by strictly increasing key, in O(n)
+    template<class ForwardIt>
+    void buildFromSorted(ForwardIt first, ForwardIt last);
+    //same for a range in any order, sorts a copy first. A repeated key keeps its last value, like insert
+    template<class InputIt>
+    void sortAndBuild(InputIt first, InputIt last);
     bool isBalanced() const; //TODO
     void print() const;
     bool empty() const;
@@ -222,43 +276,109 @@ public:
         bool operator!=(const iterator& rhs) const;
 
         iterator& operator++();
+        //steps back to the previous item, begin() steps to end(). end() can't step back, use rbegin()
+        iterator& operator--();
+
+    protected:
+        friend class BinarySearchTree<Key, Value, Alloc, NodeT>;
+        iterator(NodeT* ptr);
+        NodeT *current_;
+    };
+
+    /**
+    * Walks the items from the largest key down, ++ goes to the predecessor.
+    */
+    class reverse_iterator : public iterator
+    {
+    public:
+        reverse_iterator();
+
+        reverse_iterator& operator++();
+        //steps back to the next larger item, rbegin() steps to rend(). rend() can't step back, use begin()
+        reverse_iterator& operator--();
 
     protected:
-        friend class BinarySearchTree<Key, Value>;
-        iterator(Node<Key,Value>* ptr);
-        Node<Key, Value> *current_;
+        friend class BinarySearchTree<Key, Value, Alloc, NodeT>;
+        reverse_iterator(NodeT* ptr);
     };
 
 public:
     iterator begin() const;
     iterator end() const;
+    reverse_iterator rbegin() const;
+    reverse_iterator rend() const;
     iterator find(const Key& key) const;
 
+    // Ordered lookups, O(log n)
+    //the first item whose key is not less than key, end() if there is none
+    iterator lower_bound(const Key& key) const;
+    //the first item whose key is greater than key, end() if there is none
+    iterator upper_bound(const Key& key) const;
+    //the items with this key: [lower_bound(key), upper_bound(key))
+    std::pair<iterator, iterator> equal_range(const Key& key) const;
+    //calls fn(item) for every item with lo <= key < hi, in key order. O(log n + number of items)
+    template<class Fn>
+    void forEachInRange(const Key& lo, const Key& hi, Fn fn) const;
+
+    // Single descent inserts
+    //the item with key, inserting (key, value) if the key is missing. second is true if it was inserted
+    std::pair<iterator, bool> try_emplace(const Key& key, const Value& value);
+    //calls fn(value) on key's value, which is Value() if the key was missing, and returns the value
+    template<class Fn>
+    Value& upsert(const Key& key, Fn fn);
+    //insert next to hint, the item the new key goes right before (end() to append). With a right hint
+    //it costs the walk from hint to its predecessor instead of a search from the root, O(1) for end()
+    iterator insert(iterator hint, const std::pair<const Key, Value>& keyValuePair);
+
 protected:
     // Mandatory helper functions
-    Node<Key, Value>* internalFind(const Key& k) const; // TODO
-    Node<Key, Value> *getSmallestNode() const;  // TODO
-    static Node<Key, Value>* predecessor(Node<Key, Value>* current); // TODO
+    NodeT* internalFind(const Key& k) const; // TODO
+    NodeT *getSmallestNode() const;  // TODO
+    NodeT* getLargestNode() const;
+    //first node with key >= key, or > key if strict
+    NodeT* boundNode(const Key& key, bool strict) const;
+    static NodeT* predecessor(NodeT* current); // TODO
     // Note:  static means these functions don't have a "this" pointer
     //        and instead just use the input argument.
 
     // Provided helper functions
-    virtual void printRoot (Node<Key, Value> *r) const;
-    virtual void nodeSwap( Node<Key,Value>* n1, Node<Key,Value>* n2) ;
+    virtual void printRoot (NodeT *r) const;
+    virtual void nodeSwap( NodeT* n1, NodeT* n2) ;
 
     // Add helper functions here
-    void clearNodeFromTree(Node<Key, Value>* current, std::string mode);
-    int balanceHelper(Node<Key, Value>* current) const; 
-    static Node<Key, Value>* successor(Node<Key, Value>* current);
-    Node<Key, Value>* closestFind(const Key& k) const;
+    void clearNodeFromTree(NodeT* current, std::string mode);
+    //onlyDestroy leaves the memory to the allocator's releaseAll()
+    void deleteAll(NodeT* current, bool onlyDestroy);
+    template<class ForwardIt>
+    NodeT* buildSubtree(ForwardIt& next, std::size_t n, int& height);
+    NodeT* findOrCreate(const Key& key, const Value& value, bool& inserted);
+    //creates (key, value) as parent's left or right child, which must be free
+    NodeT* linkLeaf(NodeT* parent, bool right, const Key& key, const Value& value);
+    //called by insert, try_emplace and upsert right after a new leaf is linked in
+    virtual void insertedLeaf(NodeT* leaf);
+    //called by buildFromSorted() for every node with the heights of its two subtrees
+    virtual void setBuiltHeights(NodeT* node, int leftHeight, int rightHeight);
+    int balanceHelper(NodeT* current) const; 
+    static NodeT* successor(NodeT* current);
+    NodeT* closestFind(const Key& k) const;
+    //lets derived trees hand out iterators to their nodes
+    iterator makeIterator(NodeT* node) const;
+    //every node is made and freed through these
+    NodeT* createNode(const Key& key, const Value& value, NodeT* parent);
+    void destroyNode(NodeT* node);
+    //gives the allocator's memory back once every node is destroyed
+    void releaseNodes();
     //has this so that it can be used by floorplan.cpp
 public:
     virtual Value& operator[](Key k);
     virtual void erase(iterator it);
 
 protected:
-    Node<Key, Value>* root_;
-    // You should not need other data members
+    NodeT* root_;
+    //the node with the largest key, so appending a new largest key needs no walk down
+    NodeT* rightmost_;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<NodeT> NodeAlloc;
+    NodeAlloc nodeAlloc_;
 };
 
 /*
@@ -270,8 +390,8 @@ Begin implementations for the BinarySearchTree::iterator class.
 /**
 * Explicit constructor that initializes an iterator with a given node pointer.
 */
-template<class Key, class Value>
-BinarySearchTree<Key, Value>::iterator::iterator(Node<Key,Value> *ptr)
+template<class Key, class Value, class Alloc, class NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::iterator(NodeT *ptr)
 {
     current_ = ptr;
 }
@@ -279,8 +399,8 @@ BinarySearchTree<Key, Value>::iterator::iterator(Node<Key,Value> *ptr)
 /**
 * A default constructor that initializes the iterator to NULL.
 */
-template<class Key, class Value>
-BinarySearchTree<Key, Value>::iterator::iterator()
+template<class Key, class Value, class Alloc, class NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::iterator()
 {
     current_ = NULL;
 }
@@ -288,9 +408,9 @@ BinarySearchTree<Key, Value>::iterator::iterator()
 /**
 * Provides access to the item.
 */
-template<class Key, class Value>
+template<class Key, class Value, class Alloc, class NodeT>
 std::pair<const Key,Value> &
-BinarySearchTree<Key, Value>::iterator::operator*() const
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator*() const
 {
     return current_->getItem();
 }
@@ -298,9 +418,9 @@ BinarySearchTree<Key, Value>::iterator::operator*() const
 /**
 * Provides access to the address of the item.
 */
-template<class Key, class Value>
+template<class Key, class Value, class Alloc, class NodeT>
 std::pair<const Key,Value> *
-BinarySearchTree<Key, Value>::iterator::operator->() const
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator->() const
 {
     return &(current_->getItem());
 }
@@ -309,10 +429,10 @@ BinarySearchTree<Key, Value>::iterator::operator->() const
 * Checks if 'this' iterator's internals have the same value
 * as 'rhs'
 */
-template<class Key, class Value>
+template<class Key, class Value, class Alloc, class NodeT>
 bool
-BinarySearchTree<Key, Value>::iterator::operator==(
-    const BinarySearchTree<Key, Value>::iterator& rhs) const
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator==(
+    const BinarySearchTree<Key, Value, Alloc, NodeT>::iterator& rhs) const
 {
     // TODO
     return current_ == rhs.current_;
@@ -322,10 +442,10 @@ BinarySearchTree<Key, Value>::iterator::operator==(
 * Checks if 'this' iterator's internals have a different value
 * as 'rhs'
 */
-template<class Key, class Value>
+template<class Key, class Value, class Alloc, class NodeT>
 bool
-BinarySearchTree<Key, Value>::iterator::operator!=(
-    const BinarySearchTree<Key, Value>::iterator& rhs) const
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator!=(
+    const BinarySearchTree<Key, Value, Alloc, NodeT>::iterator& rhs) const
 {
     return !(current_ == rhs.current_);
 
@@ -335,15 +455,62 @@ BinarySearchTree<Key, Value>::iterator::operator!=(
 /**
 * Advances the iterator's location using an in-order sequencing
 */
-template<class Key, class Value>
-typename BinarySearchTree<Key, Value>::iterator&
-BinarySearchTree<Key, Value>::iterator::operator++()
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator&
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator++()
 {
     // TODO
     current_ = successor(current_);
     return *this;
 }
 
+/**
+* Moves the iterator back using an in-order sequencing
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator&
+BinarySearchTree<Key, Value, Alloc, NodeT>::iterator::operator--()
+{
+    current_ = predecessor(current_);
+    return *this;
+}
+
+template<class Key, class Value, class Alloc, class NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator::reverse_iterator() :
+    iterator()
+{
+
+}
+
+template<class Key, class Value, class Alloc, class NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator::reverse_iterator(NodeT* ptr) :
+    iterator(ptr)
+{
+
+}
+
+/**
+* Advances to the next smaller key
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator&
+BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator::operator++()
+{
+    this->current_ = predecessor(this->current_);
+    return *this;
+}
+
+/**
+* Moves back to the next larger key, the mirror image of iterator::operator--()
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator&
+BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator::operator--()
+{
+    this->current_ = successor(this->current_);
+    return *this;
+}
+
 
 /*
 -------------------------------------------------------------
@@ -360,14 +527,15 @@ Begin implementations for the BinarySearchTree class.
 /**
 * Default constructor for a BinarySearchTree, which sets the root to NULL.
 */
-template<class Key, class Value>
-BinarySearchTree<Key, Value>::BinarySearchTree()
+template<class Key, class Value, class Alloc, class NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::BinarySearchTree()
 {
     root_ = NULL;
+    rightmost_ = NULL;
 }
 
-template<typename Key, typename Value>
-BinarySearchTree<Key, Value>::~BinarySearchTree()
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+BinarySearchTree<Key, Value, Alloc, NodeT>::~BinarySearchTree()
 {
     clear();
 }
@@ -375,14 +543,14 @@ BinarySearchTree<Key, Value>::~BinarySearchTree()
 /**
  * Returns true if tree is empty
 */
-template<class Key, class Value>
-bool BinarySearchTree<Key, Value>::empty() const
+template<class Key, class Value, class Alloc, class NodeT>
+bool BinarySearchTree<Key, Value, Alloc, NodeT>::empty() const
 {
     return root_ == NULL;
 }
 
-template<typename Key, typename Value>
-void BinarySearchTree<Key, Value>::print() const
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::print() const
 {
     printRoot(root_);
     std::cout << "\n";
@@ -391,43 +559,110 @@ void BinarySearchTree<Key, Value>::print() const
 /**
 * Returns an iterator to the "smallest" item in the tree
 */
-template<class Key, class Value>
-typename BinarySearchTree<Key, Value>::iterator
-BinarySearchTree<Key, Value>::begin() const
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::begin() const
 {
-    BinarySearchTree<Key, Value>::iterator begin(getSmallestNode());
+    BinarySearchTree<Key, Value, Alloc, NodeT>::iterator begin(getSmallestNode());
     return begin;
 }
 
 /**
 * Returns an iterator whose value means INVALID
 */
-template<class Key, class Value>
-typename BinarySearchTree<Key, Value>::iterator
-BinarySearchTree<Key, Value>::end() const
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::end() const
 {
-    BinarySearchTree<Key, Value>::iterator end(NULL);
+    BinarySearchTree<Key, Value, Alloc, NodeT>::iterator end(NULL);
     return end;
 }
 
+/**
+* Returns a reverse iterator to the "largest" item in the tree
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::rbegin() const
+{
+    return reverse_iterator(getLargestNode());
+}
+
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::reverse_iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::rend() const
+{
+    return reverse_iterator(NULL);
+}
+
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::lower_bound(const Key& key) const
+{
+    return iterator(boundNode(key, false));
+}
+
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::upper_bound(const Key& key) const
+{
+    return iterator(boundNode(key, true));
+}
+
+/**
+* Keys are unique, so the range holds one item or none
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+std::pair<typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator,
+          typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator>
+BinarySearchTree<Key, Value, Alloc, NodeT>::equal_range(const Key& key) const
+{
+    NodeT* first = boundNode(key, false);
+    NodeT* last = first;
+    if(first != NULL && !(key < first->getKey())){
+        last = successor(first);
+    }
+    return std::make_pair(iterator(first), iterator(last));
+}
+
+/**
+* One descent to the first key >= lo, then successor steps until a key reaches hi.
+* The successor steps over k consecutive nodes cost O(k + log n) all together
+*/
+template<class Key, class Value, class Alloc, class NodeT>
+template<class Fn>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::forEachInRange(const Key& lo, const Key& hi, Fn fn) const
+{
+    for(NodeT* curr = boundNode(lo, false) ; curr != NULL && curr->getKey() < hi ; curr = successor(curr)){
+        fn(curr->getItem());
+    }
+}
+
 /**
 * Returns an iterator to the item with the given key, k
 * or the end iterator if k does not exist in the tree
 */
-template<class Key, class Value>
-typename BinarySearchTree<Key, Value>::iterator
-BinarySearchTree<Key, Value>::find(const Key & k) const
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::find(const Key & k) const
 {
-    Node<Key, Value> *curr = internalFind(k);
-    BinarySearchTree<Key, Value>::iterator it(curr);
+    NodeT *curr = internalFind(k);
+    BinarySearchTree<Key, Value, Alloc, NodeT>::iterator it(curr);
     return it;
 }
 
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::makeIterator(NodeT* node) const
+{
+    return iterator(node);
+}
+
 /**
  * For compatibility with map implementation
  * */
-template<class Key, class Value>
-Value& BinarySearchTree<Key, Value>::operator[](Key k){
+template<class Key, class Value, class Alloc, class NodeT>
+Value& BinarySearchTree<Key, Value, Alloc, NodeT>::operator[](Key k){
     iterator result = find(k);
     return result.current_->getValue();
 }
@@ -435,8 +670,8 @@ Value& BinarySearchTree<Key, Value>::operator[](Key k){
 /**
  * For compatibility with map implementation
  * */
-template<class Key, class Value>
-void BinarySearchTree<Key, Value>::erase(iterator it){
+template<class Key, class Value, class Alloc, class NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::erase(iterator it){
     remove(it.current_->getKey());
 }
 
@@ -446,48 +681,158 @@ void BinarySearchTree<Key, Value>::erase(iterator it){
 * An insert method to insert into a Binary Search Tree.
 * The tree will not remain balanced when inserting.
 */
-template<class Key, class Value>
-void BinarySearchTree<Key, Value>::insert(const std::pair<const Key, Value> &keyValuePair)
+template<class Key, class Value, class Alloc, class NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::insert(const std::pair<const Key, Value> &keyValuePair)
+{
+    bool inserted;
+    NodeT* node = findOrCreate(keyValuePair.first, keyValuePair.second, inserted);
+    //if equal, then overwrite the previous value with new
+    if(!inserted){
+        node->setValue(keyValuePair.second);
+    }
+}
+
+/**
+ * Returns the item with the key, after inserting (key, value) if the key was missing.
+ * The bool is true if it was inserted. Either way it is a single walk down the tree
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+std::pair<typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator, bool>
+BinarySearchTree<Key, Value, Alloc, NodeT>::try_emplace(const Key& key, const Value& value)
+{
+    bool inserted;
+    NodeT* node = findOrCreate(key, value, inserted);
+    return std::make_pair(iterator(node), inserted);
+}
+
+/**
+ * Read-modify-write of one value in a single walk down the tree: a missing key is inserted
+ * with Value() first. Returns the value after fn(value), e.g. upsert(word, increment) counts words
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+template<class Fn>
+Value& BinarySearchTree<Key, Value, Alloc, NodeT>::upsert(const Key& key, Fn fn)
 {
+    bool inserted;
+    NodeT* node = findOrCreate(key, Value(), inserted);
+    fn(node->getValue());
+    return node->getValue();
+}
+
+/**
+ * Helper function for insert, try_emplace and upsert: walks down to the node with the key,
+ * or creates (key, value) where the walk falls off the tree and calls insertedLeaf() on it
+ * inserted tells which of the two happened
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::findOrCreate(const Key& key, const Value& value, bool& inserted)
+{
+    inserted = true;
     //case when tree is empty
     if(empty()){
-        Node<Key, Value>* first = new Node<Key, Value>(keyValuePair.first, keyValuePair.second, NULL);
-        root_ = first;
-        return;
+        return linkLeaf(NULL, false, key, value);
+    }
+    //appending a new largest key, as with keys that come in sorted order
+    if(rightmost_->getKey() < key){
+        return linkLeaf(rightmost_, true, key, value);
     }
 
-    Node<Key, Value>* curr = root_;
+    NodeT* curr = root_;
     while(1){
-        if(curr->getKey() < keyValuePair.first){
+        if(curr->getKey() < key){
             if(curr->getRight() == NULL){
                 break;
             }
             curr = curr->getRight();
-        } else if(curr->getKey() > keyValuePair.first){
+        } else if(key < curr->getKey()){
             if(curr->getLeft() == NULL){
                 break;
             }
             curr = curr->getLeft();
-        //if equal, then overwrite the previous value with new
         } else{
-            curr->setValue(keyValuePair.second);
-            return;
+            inserted = false;
+            return curr;
         }
     }
-    Node<Key, Value>* ans = new Node<Key, Value>(keyValuePair.first, keyValuePair.second, curr);
-    if(curr->getKey() < keyValuePair.first){
-        curr->setRight(ans);
+    return linkLeaf(curr, curr->getKey() < key, key, value);
+}
+
+/**
+ * Helper function for the inserts: creates the node under parent (as the root if parent is NULL),
+ * keeps rightmost_ up to date and calls insertedLeaf() on it
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::linkLeaf(NodeT* parent, bool right, const Key& key, const Value& value)
+{
+    NodeT* leaf = createNode(key, value, parent);
+    if(parent == NULL){
+        root_ = leaf;
+        rightmost_ = leaf;
+    } else if(right){
+        parent->setRight(leaf);
+        if(parent == rightmost_){
+            rightmost_ = leaf;
+        }
     } else {
-        curr->setLeft(ans);
+        parent->setLeft(leaf);
+    }
+    insertedLeaf(leaf);
+    return leaf;
+}
+
+/**
+ * Hinted insert, like std::map's: hint should be the item right after the new key (end() if the
+ * key is the new largest). The new node then goes to hint's free left link, or to the free right
+ * link of hint's predecessor, after a key comparison with each of the two.
+ * Finding the predecessor is not free: it is the largest node of hint's left subtree, or the
+ * first ancestor hint is right of, so the walk is as long as the path between the two.
+ * That is O(1) for end() (the largest node is kept) and for a hint whose predecessor is its
+ * parent or its left child, but O(log n) for a hint deep in a left spine, e.g. always begin().
+ * A wrong hint costs nothing but those checks, the key is then inserted from the root.
+ * An existing key gets the new value, like insert. Returns the item with the key
+ * runtime = O(walk to hint's predecessor) with a right hint (plus rebalancing), at most O(log n)
+ * for a balanced tree, O(log n) for a wrong hint
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+typename BinarySearchTree<Key, Value, Alloc, NodeT>::iterator
+BinarySearchTree<Key, Value, Alloc, NodeT>::insert(iterator hint, const std::pair<const Key, Value>& keyValuePair)
+{
+    const Key& key = keyValuePair.first;
+    NodeT* next = hint.current_;
+    //the key goes between prev and next
+    NodeT* prev = next == NULL ? rightmost_ : predecessor(next);
+    if((next == NULL || key < next->getKey()) && (prev == NULL || prev->getKey() < key)){
+        if(next != NULL && next->getLeft() == NULL){
+            return iterator(linkLeaf(next, false, key, keyValuePair.second));
+        }
+        //next's left subtree ends at prev, so prev has no right child
+        if(prev != NULL){
+            return iterator(linkLeaf(prev, true, key, keyValuePair.second));
+        }
+        return iterator(linkLeaf(NULL, false, key, keyValuePair.second));
+    }
+    bool inserted;
+    NodeT* node = findOrCreate(key, keyValuePair.second, inserted);
+    if(!inserted){
+        node->setValue(keyValuePair.second);
     }
-    return;
+    return iterator(node);
+}
+
+/**
+ * A plain BST doesn't rebalance
+ * */
+template<class Key, class Value, class Alloc, class NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::insertedLeaf(NodeT*)
+{
+
 }
 
 /**
  * Added for debugging convienience
  * */
-template <class Key, class Value>
-void BinarySearchTree<Key, Value>::insert(Key k, Value v){
+template<class Key, class Value, class Alloc, class NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::insert(Key k, Value v){
     std::pair<Key, Value> p = std::pair<Key, Value>(k, v);
     insert(p);
 }
@@ -497,19 +842,23 @@ void BinarySearchTree<Key, Value>::insert(Key k, Value v){
 * A remove method to remove a specific key from a Binary Search Tree.
 * The tree may not remain balanced after removal.
 */
-template<typename Key, typename Value>
-void BinarySearchTree<Key, Value>::remove(const Key& key)
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::remove(const Key& key)
 {
-    Node<Key, Value>* pos = internalFind(key);
+    NodeT* pos = internalFind(key);
     //case where the element doesn't exist
     if(pos == NULL){
         return;
-    } else
+    }
+    //the largest node has no right child, the next largest is in its left subtree or above it
+    if(pos == rightmost_){
+        rightmost_ = predecessor(pos);
+    }
     //case where it is a leaf node
     if(pos->getLeft() == NULL && pos->getRight() == NULL){
         //case where it is root node
         if(pos->getParent() == NULL){
-            delete pos;
+            destroyNode(pos);
             root_ = NULL;
         } else {
         clearNodeFromTree(pos, "leaf");
@@ -519,7 +868,7 @@ void BinarySearchTree<Key, Value>::remove(const Key& key)
         clearNodeFromTree(pos, "oneChild");
     //case where it has 2 children
     } else{
-        Node<Key, Value>* pred = predecessor(pos);
+        NodeT* pred = predecessor(pos);
         nodeSwap(pos, pred);
         if(DEBUG){ std::cout << "Swapped with predecessor: " << pred->getKey() << std::endl;}
         //delete the pos, which is now in pred's place
@@ -540,8 +889,8 @@ void BinarySearchTree<Key, Value>::remove(const Key& key)
  *  "oneChild" is when the node to be deleted has one child
  *  any other input does nothing
  * */
-template<class Key, class Value>
-void BinarySearchTree<Key, Value>::clearNodeFromTree(Node<Key, Value>* current, std::string mode){
+template<class Key, class Value, class Alloc, class NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::clearNodeFromTree(NodeT* current, std::string mode){
     //case where current is a leaf node
     if(mode == "leaf"){
         if(DEBUG){std::cout<<"doing leaf node algo" << std::endl;}
@@ -550,10 +899,10 @@ void BinarySearchTree<Key, Value>::clearNodeFromTree(Node<Key, Value>* current,
         } else {
             current->getParent()->setLeft(NULL);
         }
-        delete current;
+        destroyNode(current);
     } else if(mode == "oneChild"){
         if(DEBUG){std::cout<<"doing one child algo" << std::endl;}
-        Node<Key, Value>* child;
+        NodeT* child;
         if(current->getLeft() != NULL){
             child = current->getLeft();
         } else {
@@ -571,21 +920,21 @@ void BinarySearchTree<Key, Value>::clearNodeFromTree(Node<Key, Value>* current,
         }
         //update root if necessary
         if(root_ == current){ root_ = child;}
-        delete current;
+        destroyNode(current);
     }
 }
 
 
-template<class Key, class Value>
-Node<Key, Value>*
-BinarySearchTree<Key, Value>::predecessor(Node<Key, Value>* current)
+template<class Key, class Value, class Alloc, class NodeT>
+NodeT*
+BinarySearchTree<Key, Value, Alloc, NodeT>::predecessor(NodeT* current)
 {
     //case 0: current is NULL
     if(current == NULL){
         return NULL;
     }
     
-    Node<Key, Value>* temp = current;
+    NodeT* temp = current;
     //case 1: the node has a LST
     if(current->getLeft() != NULL){
         //go down left, then all the way right
@@ -617,15 +966,15 @@ BinarySearchTree<Key, Value>::predecessor(Node<Key, Value>* current)
  * Used for iterator operator++ function
  * Returns NULL if no sucessor
  * */
-template <class Key, class Value>
-Node<Key, Value>*
-BinarySearchTree<Key, Value>::successor(Node<Key, Value>* current){
+template<class Key, class Value, class Alloc, class NodeT>
+NodeT*
+BinarySearchTree<Key, Value, Alloc, NodeT>::successor(NodeT* current){
     //case 0: current is NULL
     if(current == NULL){
         return NULL;
     }
     
-    Node<Key, Value>* temp = current;
+    NodeT* temp = current;
     //case 1: the node has a RST
     if(current->getRight() != NULL){
         //go down right, then all the way left
@@ -656,28 +1005,188 @@ BinarySearchTree<Key, Value>::successor(Node<Key, Value>* current){
 /**
 * A method to remove all contents of the tree and
 * reset the values in the tree for use again.
+* Also run by the destructor. The nodes are freed with a post-order walk, children before
+* their parent, without any searching or rebalancing, so it is O(n) for every kind of tree.
+* With a pool allocator that no other tree shares the nodes are only destroyed, and with
+* keys/values that have no destructor even the walk is skipped: the pool's chunks are freed
+* directly, in O(chunks).
 */
-template<typename Key, typename Value>
-void BinarySearchTree<Key, Value>::clear()
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::clear()
 {
-    while(!empty()){
-        if(DEBUG){std::cout << "about to delete: " << getSmallestNode()->getKey() << std::endl;}
-        remove(getSmallestNode()->getKey()); 
-        if(DEBUG){print();}
+    bool atOnce = releasesAllAtOnce(nodeAlloc_);
+    if(!(atOnce && std::is_trivially_destructible<NodeT>::value)){
+        deleteAll(root_, atOnce);
     }
     root_ = NULL;
+    rightmost_ = NULL;
+    releaseNodes();
+}
+
+/**
+ * Helper function for clear(): frees the subtree at current, iteratively and in post-order
+ * It goes down to a leaf, frees it, unlinks it from its parent and continues from the parent,
+ * so no stack is needed however deep the tree is. Every node is visited at most 3 times
+ * */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::deleteAll(NodeT* current, bool onlyDestroy)
+{
+    NodeT* top = current == NULL ? NULL : current->getParent();
+    while(current != top){
+        if(current->getLeft() != NULL){
+            current = current->getLeft();
+        } else if(current->getRight() != NULL){
+            current = current->getRight();
+        } else {
+            NodeT* parent = current->getParent();
+            if(parent != top){
+                if(parent->getLeft() == current){
+                    parent->setLeft(NULL);
+                } else {
+                    parent->setRight(NULL);
+                }
+            }
+            if(onlyDestroy){
+                //the memory goes back with the pool's chunks
+                std::allocator_traits<NodeAlloc>::destroy(nodeAlloc_, current);
+            } else {
+                destroyNode(current);
+            }
+            current = parent;
+        }
+    }
+}
+
+/**
+ * Bulk load: builds a perfectly balanced tree out of a sorted range, without any searching
+ * or rotations. The middle item becomes the root and both halves are built the same way.
+ * Nodes are created in key order, so with the pool allocator (which gets one chunk for the
+ * whole tree) they end up in memory in the order the iterator walks them.
+ * The keys must be strictly increasing, use sortAndBuild() otherwise.
+ * runtime = O(n), two passes over the range (one to count it)
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+template<class ForwardIt>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::buildFromSorted(ForwardIt first, ForwardIt last)
+{
+    clear();
+    std::size_t n = std::distance(first, last);
+    reserveAll(nodeAlloc_, n);
+    int height;
+    root_ = buildSubtree(first, n, height);
+    rightmost_ = getLargestNode();
+}
+
+/**
+ * Copies the range, sorts the copy by key and bulk loads it.
+ * Of the items with the same key only the last one is kept, so the result is the same as
+ * inserting the items one by one.
+ * runtime = O(n log n) for the sort, the build itself is O(n)
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+template<class InputIt>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::sortAndBuild(InputIt first, InputIt last)
+{
+    std::vector<std::pair<Key, Value> > items;
+    for( ; first != last ; ++first){
+        items.push_back(std::pair<Key, Value>(first->first, first->second));
+    }
+    //stable, so the last of equal keys is still last
+    std::stable_sort(items.begin(), items.end(),
+        [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b){ return a.first < b.first; });
+    std::size_t kept = 0;
+    for(std::size_t i = 0 ; i < items.size() ; i++){
+        if(i + 1 < items.size() && !(items[i].first < items[i+1].first)){
+            continue;
+        }
+        if(kept != i){
+            items[kept] = items[i];
+        }
+        kept++;
+    }
+    items.erase(items.begin() + kept, items.end());
+    buildFromSorted(items.begin(), items.end());
+}
+
+/**
+ * Helper function for buildFromSorted(): builds a subtree of the next n items and returns its root
+ * The left half is built first, then the middle node takes next's item, then the right half.
+ * The right half gets the extra item when n is even, height is set to the subtree's height
+ * The recursion is only log2(n) deep
+ * */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+template<class ForwardIt>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::buildSubtree(ForwardIt& next, std::size_t n, int& height)
+{
+    if(n == 0){
+        height = 0;
+        return NULL;
+    }
+    int leftHeight, rightHeight;
+    NodeT* left = buildSubtree(next, (n - 1) / 2, leftHeight);
+    NodeT* node = createNode(next->first, next->second, NULL);
+    ++next;
+    NodeT* right = buildSubtree(next, n - 1 - (n - 1) / 2, rightHeight);
+    node->setLeft(left);
+    node->setRight(right);
+    if(left != NULL){ left->setParent(node); }
+    if(right != NULL){ right->setParent(node); }
+    setBuiltHeights(node, leftHeight, rightHeight);
+    height = std::max(leftHeight, rightHeight) + 1;
+    return node;
+}
+
+/**
+ * A plain BST keeps no balance information
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::setBuiltHeights(NodeT*, int, int)
+{
+
+}
+
+/**
+ * Allocates a node from the tree's allocator and constructs it in place.
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::createNode(const Key& key, const Value& value, NodeT* parent)
+{
+    NodeT* node = std::allocator_traits<NodeAlloc>::allocate(nodeAlloc_, 1);
+    std::allocator_traits<NodeAlloc>::construct(nodeAlloc_, node, key, value, parent);
+    return node;
+}
+
+/**
+ * Destroys a node made by createNode() and hands its memory back to the allocator,
+ * which puts it on the pool's free list for the next insert.
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::destroyNode(NodeT* node)
+{
+    std::allocator_traits<NodeAlloc>::destroy(nodeAlloc_, node);
+    std::allocator_traits<NodeAlloc>::deallocate(nodeAlloc_, node, 1);
+}
+
+/**
+ * Called by clear() when the tree is empty. A pool frees all of its chunks at once,
+ * unless another tree shares it (see AVLTree::split()).
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::releaseNodes()
+{
+    releaseAll(nodeAlloc_);
 }
 
 
 /**
 * A helper function to find the smallest node in the tree.
 */
-template<typename Key, typename Value>
-Node<Key, Value>*
-BinarySearchTree<Key, Value>::getSmallestNode() const
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT*
+BinarySearchTree<Key, Value, Alloc, NodeT>::getSmallestNode() const
 {
     if(!empty()){
-        Node<Key, Value>* temp = root_;
+        NodeT* temp = root_;
         while(temp->getLeft() != NULL){
             temp = temp->getLeft();
         }
@@ -687,15 +1196,50 @@ BinarySearchTree<Key, Value>::getSmallestNode() const
     }
 }
 
+/**
+* A helper function to find the largest node in the tree.
+*/
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT*
+BinarySearchTree<Key, Value, Alloc, NodeT>::getLargestNode() const
+{
+    NodeT* temp = root_;
+    while(temp != NULL && temp->getRight() != NULL){
+        temp = temp->getRight();
+    }
+    return temp;
+}
+
+/**
+* Helper function for lower_bound/upper_bound: walks down like a find and remembers the
+* last node it went left from, which is the smallest key seen that is big enough
+*/
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::boundNode(const Key& key, bool strict) const
+{
+    NodeT* bound = NULL;
+    NodeT* temp = root_;
+    while(temp != NULL){
+        bool bigEnough = strict ? key < temp->getKey() : !(temp->getKey() < key);
+        if(bigEnough){
+            bound = temp;
+            temp = temp->getLeft();
+        } else {
+            temp = temp->getRight();
+        }
+    }
+    return bound;
+}
+
 /**
 * Helper function to find a node with given key, k and
 * return a pointer to it or NULL if no item with that key
 * exists
 */
-template<typename Key, typename Value>
-Node<Key, Value>* BinarySearchTree<Key, Value>::internalFind(const Key& key) const
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::internalFind(const Key& key) const
 {
-    Node<Key, Value>* found = closestFind(key);
+    NodeT* found = closestFind(key);
     if(found == NULL){
         return NULL;
     }
@@ -710,12 +1254,12 @@ Node<Key, Value>* BinarySearchTree<Key, Value>::internalFind(const Key& key) con
  * Function that finds the closest node to the given key
  * Purpose is to find the parent of a node after the node is deleted
  * */
-template<typename Key, typename Value>
-Node<Key, Value>* BinarySearchTree<Key, Value>::closestFind(const Key& key) const{
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+NodeT* BinarySearchTree<Key, Value, Alloc, NodeT>::closestFind(const Key& key) const{
     if(empty()){
         return NULL;
     } else {
-        Node<Key, Value>* temp = root_;
+        NodeT* temp = root_;
         while(temp->getKey() != key){
             if(temp->getKey() > key){
                 if(temp->getLeft() == NULL){
@@ -736,8 +1280,8 @@ Node<Key, Value>* BinarySearchTree<Key, Value>::closestFind(const Key& key) cons
 /**
  * Return true iff the BST is balanced.
  */
-template<typename Key, typename Value>
-bool BinarySearchTree<Key, Value>::isBalanced() const
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+bool BinarySearchTree<Key, Value, Alloc, NodeT>::isBalanced() const
 {
     int h = balanceHelper(root_);
     if(h == -1){
@@ -752,8 +1296,8 @@ bool BinarySearchTree<Key, Value>::isBalanced() const
  * height calculator with a twist: if tree is unbalanced, will return -1 for height
  * If one of its sub tree returns -1, it will return -1
  * */
-template<class Key, class Value>
-int BinarySearchTree<Key, Value>::balanceHelper(Node<Key, Value>* current) const{
+template<class Key, class Value, class Alloc, class NodeT>
+int BinarySearchTree<Key, Value, Alloc, NodeT>::balanceHelper(NodeT* current) const{
     //base cases:
     if(current == NULL){
         return 0;
@@ -780,25 +1324,25 @@ int BinarySearchTree<Key, Value>::balanceHelper(Node<Key, Value>* current) const
 }
 
 
-template<typename Key, typename Value>
-void BinarySearchTree<Key, Value>::nodeSwap( Node<Key,Value>* n1, Node<Key,Value>* n2)
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::nodeSwap( NodeT* n1, NodeT* n2)
 {
     if((n1 == n2) || (n1 == NULL) || (n2 == NULL) ) {
         return;
     }
-    Node<Key, Value>* n1p = n1->getParent();
-    Node<Key, Value>* n1r = n1->getRight();
-    Node<Key, Value>* n1lt = n1->getLeft();
+    NodeT* n1p = n1->getParent();
+    NodeT* n1r = n1->getRight();
+    NodeT* n1lt = n1->getLeft();
     bool n1isLeft = false;
     if(n1p != NULL && (n1 == n1p->getLeft())) n1isLeft = true;
-    Node<Key, Value>* n2p = n2->getParent();
-    Node<Key, Value>* n2r = n2->getRight();
-    Node<Key, Value>* n2lt = n2->getLeft();
+    NodeT* n2p = n2->getParent();
+    NodeT* n2r = n2->getRight();
+    NodeT* n2lt = n2->getLeft();
     bool n2isLeft = false;
     if(n2p != NULL && (n2 == n2p->getLeft())) n2isLeft = true;
 
 
-    Node<Key, Value>* temp;
+    NodeT* temp;
     temp = n1->getParent();
     n1->setParent(n2->getParent());
     n2->setParent(temp);
@@ -0,0 +1,384 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <new>
+#include "../MemoryPool/memorypool.h"
+
+/**
+ * The pools of one PoolAllocator, its copies and its rebinds, one pool per slot size.
+ * Once adopt() has moved its pools into another group it only points there, and every
+ * allocator still using it switches over the next time it allocates or frees.
+ */
+class PoolGroup
+{
+public:
+    PoolGroup();
+    ~PoolGroup();
+    //the pool for slots of slotSize, made on first use
+    MemoryPool* poolFor(std::size_t slotSize);
+    //moves every pool of other into this group, other forwards here from now on
+    void adopt(const std::shared_ptr<PoolGroup>& self, PoolGroup& other);
+    //the group this one was merged into, or this one
+    const PoolGroup* current() const;
+    void release();
+
+    //set once this group's pools were moved to another group
+    std::shared_ptr<PoolGroup> mergedInto;
+
+private:
+    std::vector<MemoryPool*> pools_;
+
+    PoolGroup(const PoolGroup& other);
+    PoolGroup& operator=(const PoolGroup& other);
+};
+
+/**
+ * The default node allocator of BinarySearchTree and AVLTree, a standard allocator whose
+ * single objects come from a MemoryPool, so a tree's nodes sit next to each other in memory
+ * instead of being scattered by malloc.
+ * Copies and rebound allocators share the pools (and compare equal), so any of them can free
+ * what another one handed out. Allocators that share a pool must not be used from different
+ * threads at the same time, a default constructed allocator starts a pool of its own.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    PoolAllocator();
+    PoolAllocator(const PoolAllocator<T>& other);
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other);
+    //shares other's pool from now on, nothing allocated through this one may still be in use
+    PoolAllocator<T>& operator=(const PoolAllocator<T>& other);
+
+    //n == 1 comes from the pool, anything bigger goes straight to operator new
+    T* allocate(std::size_t n);
+    void deallocate(T* p, std::size_t n);
+    //true if no other allocator uses this pool, so release() frees everything at once
+    bool ownsPool();
+    //frees every chunk at once if ownsPool(), otherwise leaves the pool to the other allocators
+    //and starts a new one. Everything handed out must already be destroyed, and deallocated
+    //too unless ownsPool()
+    void release();
+    //makes sure the next n allocations come out of one chunk, one after the other
+    void reserve(std::size_t n);
+    //takes over other's pools, other starts a new one. What other handed out is now this pool's,
+    //and allocators that shared other's pool share this one from now on
+    void adopt(PoolAllocator<T>& other);
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const;
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const;
+
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    //what one slot of the pool needs to hold a T
+    union Slot
+    {
+        void* next;
+        alignas(T) char storage[sizeof(T)];
+    };
+    std::shared_ptr<PoolGroup> group_;
+    //group_'s pool for Slot
+    MemoryPool* pool_;
+
+    //switches to the group that group_ was merged into, if it was
+    void follow();
+};
+
+/**
+ * Frees everything an allocator handed out, if it is able to.
+ * Used by the trees after all nodes were destroyed. Only pools can do this,
+ * for every other allocator the nodes were already deallocated one by one.
+ */
+template <typename Alloc>
+void releaseAll(Alloc&)
+{
+
+}
+
+template <typename T>
+void releaseAll(PoolAllocator<T>& alloc)
+{
+    alloc.release();
+}
+
+/**
+ * True if releaseAll() will free every object at once, so they never have to be
+ * deallocated one by one, only destroyed (if they have a destructor).
+ */
+template <typename Alloc>
+bool releasesAllAtOnce(Alloc&)
+{
+    return false;
+}
+
+template <typename T>
+bool releasesAllAtOnce(PoolAllocator<T>& alloc)
+{
+    return alloc.ownsPool();
+}
+
+/**
+ * Asks an allocator to make room for n more objects in one go, if it is able to.
+ * Used by the trees before a bulk build. Only pools can do this.
+ */
+template <typename Alloc>
+void reserveAll(Alloc&, std::size_t)
+{
+
+}
+
+template <typename T>
+void reserveAll(PoolAllocator<T>& alloc, std::size_t n)
+{
+    alloc.reserve(n);
+}
+
+/**
+ * Moves everything one allocator handed out over to another, if it is able to.
+ * Used by the trees when nodes move from one tree to another. Only pools own their
+ * objects; every other allocator has to be one whose objects any copy can free (like std::allocator).
+ */
+template <typename Alloc>
+void adoptAll(Alloc&, Alloc&)
+{
+
+}
+
+template <typename T>
+void adoptAll(PoolAllocator<T>& into, PoolAllocator<T>& from)
+{
+    into.adopt(from);
+}
+
+/**
+ * An allocator that another thread can use while alloc is in use, for objects that end up
+ * with alloc's owner (see adoptAll). Other allocators are copied, so they have to be thread
+ * safe like std::allocator. A pool is not, so this is a new pool for alloc to adopt afterwards.
+ */
+template <typename Alloc>
+Alloc separateAllocator(const Alloc& alloc)
+{
+    return alloc;
+}
+
+template <typename T>
+PoolAllocator<T> separateAllocator(const PoolAllocator<T>&)
+{
+    return PoolAllocator<T>();
+}
+
+/*
+  ------------------------------------------------
+  Begin implementations for the PoolGroup class.
+  ------------------------------------------------
+*/
+
+inline PoolGroup::PoolGroup()
+{
+
+}
+
+inline PoolGroup::~PoolGroup()
+{
+    for(std::size_t i = 0 ; i < pools_.size() ; i++){
+        delete pools_[i];
+    }
+}
+
+/**
+ * A tree only ever uses one or two slot sizes, so a linear search is enough
+ */
+inline MemoryPool* PoolGroup::poolFor(std::size_t slotSize)
+{
+    for(std::size_t i = 0 ; i < pools_.size() ; i++){
+        if(pools_[i]->slotSize() == slotSize){
+            return pools_[i];
+        }
+    }
+    pools_.push_back(new MemoryPool(slotSize));
+    return pools_.back();
+}
+
+/**
+ * Pools of the same slot size are merged, the others just change groups.
+ * other keeps self alive, so allocators that still point at other can follow it here
+ * runtime = O(chunks + free slots of other)
+ */
+inline void PoolGroup::adopt(const std::shared_ptr<PoolGroup>& self, PoolGroup& other)
+{
+    for(std::size_t i = 0 ; i < other.pools_.size() ; i++){
+        poolFor(other.pools_[i]->slotSize())->adopt(*other.pools_[i]);
+    }
+    other.mergedInto = self;
+}
+
+inline const PoolGroup* PoolGroup::current() const
+{
+    const PoolGroup* group = this;
+    while(group->mergedInto){
+        group = group->mergedInto.get();
+    }
+    return group;
+}
+
+inline void PoolGroup::release()
+{
+    for(std::size_t i = 0 ; i < pools_.size() ; i++){
+        pools_[i]->release();
+    }
+}
+
+/*
+  ------------------------------------------------
+  Begin implementations for the PoolAllocator class.
+  ------------------------------------------------
+*/
+
+template <typename T>
+PoolAllocator<T>::PoolAllocator() :
+    group_(std::make_shared<PoolGroup>())
+{
+    pool_ = group_->poolFor(sizeof(Slot));
+}
+
+/**
+ * Copies and rebound allocators share the pools.
+ */
+template <typename T>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<T>& other) :
+    group_(other.group_),
+    pool_(other.pool_)
+{
+
+}
+
+template <typename T>
+template <typename U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other) :
+    group_(other.group_)
+{
+    while(group_->mergedInto){
+        group_ = group_->mergedInto;
+    }
+    pool_ = group_->poolFor(sizeof(Slot));
+}
+
+template <typename T>
+PoolAllocator<T>& PoolAllocator<T>::operator=(const PoolAllocator<T>& other)
+{
+    group_ = other.group_;
+    pool_ = other.pool_;
+    return *this;
+}
+
+template <typename T>
+void PoolAllocator<T>::follow()
+{
+    if(group_->mergedInto){
+        while(group_->mergedInto){
+            group_ = group_->mergedInto;
+        }
+        pool_ = group_->poolFor(sizeof(Slot));
+    }
+}
+
+/**
+ * runtime = const (amortized, see MemoryPool::allocate())
+ */
+template <typename T>
+T* PoolAllocator<T>::allocate(std::size_t n)
+{
+    if(n != 1){
+        return (T*)::operator new(n * sizeof(T));
+    }
+    follow();
+    return (T*)pool_->allocate();
+}
+
+template <typename T>
+void PoolAllocator<T>::deallocate(T* p, std::size_t n)
+{
+    if(n != 1){
+        ::operator delete(p);
+        return;
+    }
+    follow();
+    pool_->deallocate(p);
+}
+
+template <typename T>
+bool PoolAllocator<T>::ownsPool()
+{
+    follow();
+    return group_.use_count() == 1;
+}
+
+template <typename T>
+void PoolAllocator<T>::release()
+{
+    if(ownsPool()){
+        group_->release();
+    } else {
+        group_ = std::make_shared<PoolGroup>();
+        pool_ = group_->poolFor(sizeof(Slot));
+    }
+}
+
+template <typename T>
+void PoolAllocator<T>::reserve(std::size_t n)
+{
+    follow();
+    pool_->reserve(n);
+}
+
+/**
+ * The two groups are merged into this one, see PoolGroup::adopt()
+ * runtime = O(chunks + free slots of other)
+ */
+template <typename T>
+void PoolAllocator<T>::adopt(PoolAllocator<T>& other)
+{
+    follow();
+    other.follow();
+    if(group_ == other.group_){
+        return;
+    }
+    group_->adopt(group_, *other.group_);
+    other.group_ = std::make_shared<PoolGroup>();
+    other.pool_ = other.group_->poolFor(sizeof(Slot));
+}
+
+/**
+ * Two allocators are equal if they use the same pools.
+ */
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator==(const PoolAllocator<U>& other) const
+{
+    return group_->current() == other.group_->current();
+}
+
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator!=(const PoolAllocator<U>& other) const
+{
+    return !(*this == other);
+}
+
+/*
+  ----------------------------------------------
+  End implementations for the PoolAllocator class.
+  ----------------------------------------------
+*/
+
+#endif
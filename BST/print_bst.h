@@ -0,0 +1,57 @@
+#ifndef PRINT_BST_H
+#define PRINT_BST_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//levels printed by printRoot, deeper nodes are left out
+const int PRINT_BST_LEVELS = 5;
+
+/**
+ * Prints up to PRINT_BST_LEVELS levels of the tree rooted at r, one line per level.
+ * Every key is centered over its subtree and missing children are printed as "-",
+ * which is enough to see the shape of a small tree while debugging.
+ */
+template<typename Key, typename Value, typename Alloc, typename NodeT>
+void BinarySearchTree<Key, Value, Alloc, NodeT>::printRoot(NodeT* r) const
+{
+    if(r == NULL){
+        std::cout << "[empty]" << std::endl;
+        return;
+    }
+    //the keys as text, level by level, with NULL for missing nodes
+    std::vector<NodeT*> level(1, r);
+    int width = 4;
+    for(int depth = 0 ; depth < PRINT_BST_LEVELS ; depth++){
+        bool any = false;
+        for(unsigned int i = 0 ; i < level.size() ; i++){
+            if(level[i] != NULL){ any = true; }
+        }
+        if(!any){ break; }
+        //every slot on the last printed level gets `width` characters
+        int slot = width << (PRINT_BST_LEVELS - 1 - depth);
+        std::string line;
+        std::vector<NodeT*> next;
+        for(unsigned int i = 0 ; i < level.size() ; i++){
+            std::string text = "-";
+            if(level[i] != NULL){
+                std::ostringstream out;
+                out << level[i]->getKey();
+                text = out.str();
+            }
+            int pad = (slot - (int)text.size()) / 2;
+            if(pad < 0){ pad = 0; }
+            std::string cell = std::string(pad, ' ') + text;
+            cell.resize(slot > (int)cell.size() ? slot : cell.size(), ' ');
+            line += cell;
+            next.push_back(level[i] != NULL ? level[i]->getLeft() : NULL);
+            next.push_back(level[i] != NULL ? level[i]->getRight() : NULL);
+        }
+        std::cout << line << std::endl;
+        level.swap(next);
+    }
+}
+
+#endif
@@ -0,0 +1,270 @@
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "BloomFilter.h"
+
+//"BLMF" when read as little endian bytes
+const uint32_t BLOOM_FILE_MAGIC = 0x464d4c42;
+const uint32_t BLOOM_FILE_VERSION = 1;
+//the bit array is padded to this offset so it starts on a page boundary
+const uint64_t BLOOM_FILE_ALIGN = 4096;
+
+
+BloomFilter::BloomFilter(size_t numBits, unsigned int numHashes, bool concurrent, uint64_t seed){
+    //need at least one word and one hash function
+    if(numBits == 0){ numBits = 1; }
+    if(numHashes == 0){ numHashes = 1; }
+    numWords = (numBits + 63) / 64;
+    this->numHashes = numHashes;
+    this->seed = seed;
+    this->concurrent = concurrent;
+    mapping = NULL;
+    mappingSize = 0;
+    words = new uint64_t[numWords];
+    memset(words, 0, numWords * sizeof(uint64_t));
+}
+
+/**
+ * Loads a filter saved with save() by mapping the file
+ * MAP_PRIVATE makes the mapping copy-on-write: queries read the file's pages directly and
+ * an add() only copies the page it touches, the file itself is never modified
+ * */
+BloomFilter::BloomFilter(const string& path, bool concurrent){
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw bloomFileException("Could not open " + path);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BloomFileHeader)){
+        close(fd);
+        throw bloomFileException(path + " is too small to be a filter file");
+    }
+    mappingSize = st.st_size;
+    mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    //the mapping stays valid after the fd is closed
+    close(fd);
+    if(mapping == MAP_FAILED){
+        throw bloomFileException("Could not map " + path);
+    }
+
+    const BloomFileHeader* header = (const BloomFileHeader*)mapping;
+    string error = "";
+    if(header->magic != BLOOM_FILE_MAGIC){
+        error = path + " is not a filter file";
+    } else if(header->version != BLOOM_FILE_VERSION){
+        error = path + " has unsupported version " + to_string(header->version);
+    } else if(header->numBits == 0 || header->numHashes == 0 || header->numBits % 64 != 0 || header->dataOffset % sizeof(uint64_t) != 0
+              || header->dataOffset < sizeof(BloomFileHeader)
+              //written so that no sum can wrap around on a corrupted header
+              || header->dataOffset > mappingSize || header->numBits / 8 > mappingSize - header->dataOffset){
+        error = path + " is truncated or corrupted";
+    }
+    if(error != ""){
+        munmap(mapping, mappingSize);
+        throw bloomFileException(error);
+    }
+    numWords = header->numBits / 64;
+    numHashes = header->numHashes;
+    seed = header->seed;
+    this->concurrent = concurrent;
+    words = (uint64_t*)((char*)mapping + header->dataOffset);
+}
+
+BloomFilter::BloomFilter(const BloomFilter& other){
+    numWords = other.numWords;
+    numHashes = other.numHashes;
+    seed = other.seed;
+    concurrent = other.concurrent;
+    mapping = NULL;
+    mappingSize = 0;
+    words = new uint64_t[numWords];
+    memcpy(words, other.words, numWords * sizeof(uint64_t));
+}
+
+BloomFilter::~BloomFilter(){
+    release();
+}
+
+/**
+ * Helper for the destructor and assignment: frees the words however they were obtained
+ * */
+void BloomFilter::release(){
+    if(mapping != NULL){
+        munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+    } else {
+        delete [] words;
+    }
+    words = NULL;
+}
+
+BloomFilter& BloomFilter::operator=(const BloomFilter& other){
+    //check for self assignment
+    if(&other == this){ return *this; }
+    release();
+    numWords = other.numWords;
+    numHashes = other.numHashes;
+    seed = other.seed;
+    concurrent = other.concurrent;
+    words = new uint64_t[numWords];
+    memcpy(words, other.words, numWords * sizeof(uint64_t));
+    return *this;
+}
+
+size_t BloomFilter::bitCount() const{
+    return numWords * 64;
+}
+
+unsigned int BloomFilter::hashCount() const{
+    return numHashes;
+}
+
+bool BloomFilter::isConcurrent() const{
+    return concurrent;
+}
+
+/**
+ * Sets the k bits of the item
+ * In concurrent mode every word is updated with a relaxed atomic fetch_or, so no lock is needed
+ * and two threads setting bits in the same word can never lose each other's bits.
+ * The word is read first so bits that are already set don't cause a write (and a cache line bounce)
+ * */
+void BloomFilter::add(const string& k){
+    uint64_t h1, h2;
+    hash(k, h1, h2);
+    uint64_t m = bitCount();
+    for(unsigned int i = 0 ; i < numHashes ; i++){
+        uint64_t bit = (h1 + i*h2) % m;
+        uint64_t mask = 1ULL << (bit % 64);
+        if(concurrent){
+            atomic_ref<uint64_t> word(words[bit / 64]);
+            if((word.load(memory_order_relaxed) & mask) == 0){
+                word.fetch_or(mask, memory_order_relaxed);
+            }
+        } else {
+            words[bit / 64] |= mask;
+        }
+    }
+}
+
+/**
+ * Returns true if all k bits of the item are set
+ * In concurrent mode the words are read with relaxed atomic loads (plain loads on x86/ARM)
+ * Bits are never cleared, so an item whose add() has returned is never reported absent
+ * */
+bool BloomFilter::contains(const string& k) const{
+    uint64_t h1, h2;
+    hash(k, h1, h2);
+    uint64_t m = bitCount();
+    for(unsigned int i = 0 ; i < numHashes ; i++){
+        uint64_t bit = (h1 + i*h2) % m;
+        uint64_t mask = 1ULL << (bit % 64);
+        uint64_t word;
+        if(concurrent){
+            word = atomic_ref<uint64_t>(words[bit / 64]).load(memory_order_relaxed);
+        } else {
+            word = words[bit / 64];
+        }
+        if((word & mask) == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Writes the header, pads up to BLOOM_FILE_ALIGN and then writes the raw words
+ * */
+void BloomFilter::save(const string& path) const{
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    if(!out){
+        throw bloomFileException("Could not open " + path);
+    }
+    BloomFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BLOOM_FILE_MAGIC;
+    header.version = BLOOM_FILE_VERSION;
+    header.numBits = bitCount();
+    header.numHashes = numHashes;
+    header.seed = seed;
+    header.dataOffset = BLOOM_FILE_ALIGN;
+    out.write((const char*)&header, sizeof(header));
+    vector<char> padding(BLOOM_FILE_ALIGN - sizeof(header), 0);
+    out.write(padding.data(), padding.size());
+    out.write((const char*)words, numWords * sizeof(uint64_t));
+    if(!out){
+        throw bloomFileException("Could not write " + path);
+    }
+}
+
+/**
+ * Two filters can only be combined if they map every item to the same bits
+ * */
+bool BloomFilter::compatible(const BloomFilter& other) const{
+    return numWords == other.numWords && numHashes == other.numHashes && seed == other.seed;
+}
+
+/**
+ * Afterwards this filter contains everything either filter contained
+ * Same result as adding all of other's items, without needing the items
+ * */
+void BloomFilter::unionWith(const BloomFilter& other){
+    if(!compatible(other)){
+        throw incompatibleFilterException();
+    }
+    if(concurrent){
+        for(size_t i = 0 ; i < numWords ; i++){
+            atomic_ref<uint64_t>(words[i]).fetch_or(other.words[i], memory_order_relaxed);
+        }
+    } else {
+        for(size_t i = 0 ; i < numWords ; i++){
+            words[i] |= other.words[i];
+        }
+    }
+}
+
+/**
+ * Afterwards this filter contains only bits set in both filters
+ * Everything added to both is still reported present, but the false positive rate can be higher
+ * than a filter built from only the common items
+ * */
+void BloomFilter::intersectWith(const BloomFilter& other){
+    if(!compatible(other)){
+        throw incompatibleFilterException();
+    }
+    if(concurrent){
+        for(size_t i = 0 ; i < numWords ; i++){
+            atomic_ref<uint64_t>(words[i]).fetch_and(other.words[i], memory_order_relaxed);
+        }
+    } else {
+        for(size_t i = 0 ; i < numWords ; i++){
+            words[i] &= other.words[i];
+        }
+    }
+}
+
+/**
+ * Hash helper: hashes k once (FNV-1a mixed with the seed) and splits it into the two base hashes
+ * The i-th bit of an item is then h1 + i*h2 (double hashing), so k hashes only cost one pass over k
+ * h2 is forced to be odd so the probes don't collapse onto one bit
+ * */
+void BloomFilter::hash(const string& k, uint64_t& h1, uint64_t& h2) const{
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for(unsigned int i = 0 ; i < k.size() ; i++){
+        h ^= (unsigned char)k[i];
+        h *= 1099511628211ULL;
+    }
+    //splitmix64 finalizer so that every bit of h depends on every bit of the input
+    h1 = h + 0x9e3779b97f4a7c15ULL;
+    h1 = (h1 ^ (h1 >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h1 = (h1 ^ (h1 >> 27)) * 0x94d049bb133111ebULL;
+    h1 ^= (h1 >> 31);
+    h2 = (h1 ^ (h1 >> 29)) * 0xbf58476d1ce4e5b9ULL;
+    h2 = (h2 ^ (h2 >> 32)) | 1;
+}
@@ -1,21 +1,95 @@
-#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
 
 #ifndef BLOOMFILTER_H
 #define BLOOMFILTER_H
 
-class BloomFilter{
-    public:
-        BloomFilter();
-        ~BloomFilter();
+using namespace std;
 
-    private:
-        vector<int> primes_sizes = {};
-
-}
+/**
+ * Thrown when a filter file can't be opened/mapped or isn't a valid filter file
+ * */
+class bloomFileException : public exception{
+    public:
+        bloomFileException(const string& msg){
+            msg_ = msg;
+        }
+        virtual const char* what() const noexcept{
+            return msg_.c_str();
+        }
+    protected:
+        string msg_;
+};
 
+/**
+ * Thrown when combining two filters that have different sizes, hash counts or seeds
+ * */
+class incompatibleFilterException : public exception{
+    public:
+        virtual const char* what() const noexcept{
+            return "The filters have different sizes, hash counts or seeds";
+        }
+};
 
+/**
+ * Layout of the file header. The bit array starts at dataOffset, which is page aligned
+ * so the words can be used in place straight out of an mmap
+ * */
+struct BloomFileHeader{
+    //"BLMF", also tells apart files written on a machine with the other byte order
+    uint32_t magic;
+    uint32_t version;
+    uint64_t numBits;
+    uint32_t numHashes;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t dataOffset;
+};
 
+class BloomFilter{
+    public:
+        //numBits is rounded up to a multiple of 64
+        //concurrent: if true, add() and contains() can be called from many threads at once
+        BloomFilter(size_t numBits, unsigned int numHashes, bool concurrent = false, uint64_t seed = 0);
+        //maps a file written by save(). The bits are used in place (zero copy), pages are only copied if add() writes to them
+        BloomFilter(const string& path, bool concurrent = false);
+        BloomFilter(const BloomFilter& other);
+        ~BloomFilter();
+        BloomFilter& operator=(const BloomFilter& other);
+        //marks k as present
+        void add(const string& k);
+        //false means k was definitely never added, true means it probably was
+        bool contains(const string& k) const;
+        size_t bitCount() const;
+        unsigned int hashCount() const;
+        bool isConcurrent() const;
+        //writes the filter to path in the versioned, page aligned file format
+        void save(const string& path) const;
+        //word-by-word OR/AND with a filter of the same size, hash count and seed
+        void unionWith(const BloomFilter& other);
+        void intersectWith(const BloomFilter& other);
 
+    private:
+        //the bit array, stored as 64-bit words
+        uint64_t* words;
+        size_t numWords;
+        //number of hash functions (k)
+        unsigned int numHashes;
+        uint64_t seed;
+        //which mode the filter is in
+        //false: single threaded, plain loads and stores. true: lock-free atomic words
+        bool concurrent;
+        //start and length of the mmap if the words live in a mapped file, NULL if they were allocated
+        void* mapping;
+        size_t mappingSize;
 
+        //helper for add and contains: the two base hashes used for double hashing
+        void hash(const string& k, uint64_t& h1, uint64_t& h2) const;
+        //frees the words, either with delete or munmap
+        void release();
+        bool compatible(const BloomFilter& other) const;
+};
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,55 @@
+#include "BloomFilter.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ * Scaling benchmark for the concurrent BloomFilter
+ * usage: ./bench [total items]
+ * Every thread count from 1 to 32 adds the same total number of items into a fresh shared filter,
+ * then queries all of them, and reports millions of operations per second
+ * */
+int main(int argc, char* argv[]){
+    long long total = 4000000;
+    if(argc > 1){
+        total = atoll(argv[1]);
+    }
+    //keys are built up front so the benchmark only measures the filter
+    vector<string> keys(total);
+    for(long long i = 0 ; i < total ; i++){
+        keys[i] = "key" + to_string(i);
+    }
+
+    cout << "threads,add_mops,contains_mops" << endl;
+    for(int threads = 1 ; threads <= 32 ; threads *= 2){
+        //~10 bits per item, 7 hashes: about 1% false positives
+        BloomFilter bf(total * 10, 7, true);
+        double secs[2];
+        for(int phase = 0 ; phase < 2 ; phase++){
+            vector<thread> workers;
+            vector<long long> found(threads, 0);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for(int t = 0 ; t < threads ; t++){
+                workers.push_back(thread([&, t](){
+                    for(long long i = t ; i < total ; i += threads){
+                        if(phase == 0){
+                            bf.add(keys[i]);
+                        } else {
+                            found[t] += bf.contains(keys[i]);
+                        }
+                    }
+                }));
+            }
+            for(unsigned int i = 0 ; i < workers.size() ; i++){
+                workers[i].join();
+            }
+            secs[phase] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        cout << threads << "," << total / secs[0] / 1e6 << "," << total / secs[1] / 1e6 << endl;
+    }
+    return 0;
+}
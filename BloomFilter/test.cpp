@@ -0,0 +1,183 @@
+#include "BloomFilter.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+
+//makes the i-th key inserted by thread t
+string makeKey(int t, int i){
+    return "t" + to_string(t) + "_item" + to_string(i);
+}
+
+/**
+ * Saves a filter, maps it back in and checks union/intersect
+ * returns the number of failed checks
+ * */
+int fileTest(){
+    int failed = 0;
+    BloomFilter a(1 << 14, 5, false, 42);
+    BloomFilter b(1 << 14, 5, false, 42);
+    for(int i = 0 ; i < 1000 ; i++){
+        a.add(makeKey(0, i));
+        b.add(makeKey(1, i));
+    }
+    a.save("test_filter.bin");
+    BloomFilter loaded("test_filter.bin");
+    if(loaded.bitCount() != a.bitCount() || loaded.hashCount() != a.hashCount()){
+        failed++;
+    }
+    for(int i = 0 ; i < 1000 ; i++){
+        if(!loaded.contains(makeKey(0, i))){ failed++; }
+    }
+    //mapped filters are copy-on-write, so they can still be added to
+    loaded.add("only in memory");
+    if(!loaded.contains("only in memory")){ failed++; }
+
+    BloomFilter both(a);
+    both.unionWith(b);
+    for(int i = 0 ; i < 1000 ; i++){
+        if(!both.contains(makeKey(0, i)) || !both.contains(makeKey(1, i))){ failed++; }
+    }
+    both.intersectWith(a);
+    for(int i = 0 ; i < 1000 ; i++){
+        if(!both.contains(makeKey(0, i))){ failed++; }
+    }
+
+    //different seeds hash to different bits, so they can't be combined
+    BloomFilter other(1 << 14, 5, false, 7);
+    try{
+        both.unionWith(other);
+        failed++;
+    } catch(incompatibleFilterException& e){
+    }
+    try{
+        BloomFilter missing("no_such_filter.bin");
+        failed++;
+    } catch(bloomFileException& e){
+    }
+    remove("test_filter.bin");
+    return failed;
+}
+
+/**
+ * Writes bytes to path and checks that mapping it is refused
+ * */
+bool rejected(const string& path, const vector<char>& bytes){
+    ofstream out(path.c_str(), ios::binary);
+    out.write(bytes.data(), bytes.size());
+    out.close();
+    try{
+        BloomFilter loaded(path);
+    } catch(bloomFileException& e){
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Truncated files and headers whose offsets point outside the file (including ones where
+ * offset + size wraps around) must be refused before the bit array is touched
+ * returns the number of failed checks
+ * */
+int corruptFileTest(){
+    int failed = 0;
+    BloomFilter a(1 << 14, 5, false, 42);
+    a.save("corrupt_filter.bin");
+    ifstream in("corrupt_filter.bin", ios::binary);
+    vector<char> good((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    //the bit array is cut short, and a file holding only half a header
+    vector<char> truncated(good.begin(), good.end() - 8);
+    if(!rejected("corrupt_filter.bin", truncated)){ failed++; }
+    vector<char> halfHeader(good.begin(), good.begin() + sizeof(BloomFileHeader) / 2);
+    if(!rejected("corrupt_filter.bin", halfHeader)){ failed++; }
+
+    //offsets that wrap around, that overlap the header, and a bit count bigger than the file
+    uint64_t badOffsets[] = {UINT64_MAX - 7, (uint64_t)0 - a.bitCount() / 8, 0, 8};
+    for(uint64_t offset : badOffsets){
+        vector<char> corrupt = good;
+        memcpy(corrupt.data() + offsetof(BloomFileHeader, dataOffset), &offset, sizeof(offset));
+        if(!rejected("corrupt_filter.bin", corrupt)){ failed++; }
+    }
+    uint64_t hugeBits = UINT64_MAX - 63;
+    vector<char> corrupt = good;
+    memcpy(corrupt.data() + offsetof(BloomFileHeader, numBits), &hugeBits, sizeof(hugeBits));
+    if(!rejected("corrupt_filter.bin", corrupt)){ failed++; }
+
+    //the untouched bytes still load
+    if(rejected("corrupt_filter.bin", good)){ failed++; }
+    remove("corrupt_filter.bin");
+    return failed;
+}
+
+int main(){
+    if(fileTest() != 0){
+        cout << "FAILED: file format test" << endl;
+        return 1;
+    }
+    cout << "file format test passed" << endl;
+    if(corruptFileTest() != 0){
+        cout << "FAILED: corrupt file test" << endl;
+        return 1;
+    }
+    cout << "corrupt file test passed" << endl;
+
+    const int THREADS = 8;
+    const int PER_THREAD = 20000;
+    //small filter on purpose so threads fight over the same words
+    BloomFilter bf(1 << 16, 4, true);
+    atomic<int> missing(0);
+    //how many items each thread has finished adding so far
+    vector<atomic<int>> added(THREADS);
+    for(int t = 0 ; t < THREADS ; t++){
+        added[t].store(0);
+    }
+
+    vector<thread> workers;
+    for(int t = 0 ; t < THREADS ; t++){
+        workers.push_back(thread([&, t](){
+            for(int i = 0 ; i < PER_THREAD ; i++){
+                bf.add(makeKey(t, i));
+                //own items must be visible right away
+                if(!bf.contains(makeKey(t, i))){
+                    missing++;
+                }
+                added[t].store(i+1, memory_order_release);
+                //check some item another thread has already published
+                int other = (t + 1 + i) % THREADS;
+                int done = added[other].load(memory_order_acquire);
+                if(done > 0 && !bf.contains(makeKey(other, done-1))){
+                    missing++;
+                }
+            }
+        }));
+    }
+    for(unsigned int i = 0 ; i < workers.size() ; i++){
+        workers[i].join();
+    }
+
+    //no bit may have been lost by concurrent fetch_or on the same word
+    for(int t = 0 ; t < THREADS ; t++){
+        for(int i = 0 ; i < PER_THREAD ; i++){
+            if(!bf.contains(makeKey(t, i))){
+                missing++;
+            }
+        }
+    }
+
+    if(missing.load() != 0){
+        cout << "FAILED: " << missing.load() << " inserted items reported absent" << endl;
+        return 1;
+    }
+    cout << "concurrent stress test passed" << endl;
+    return 0;
+}
@@ -1,6 +1,22 @@
 #include <time.h>
 #include <math.h>
 #include "Hashtable.h"
+#include "../Heap/topk.h"
+#include "../Heap/topk.cpp"
+
+/**
+ * Orders (word, count) pairs by count, ties go to the alphabetically first word
+ * Templated so the AVLTree's pair<const string, int> items are compared without being copied first
+ * */
+struct CountLess{
+    template<class A, class B>
+    bool operator()(const A& a, const B& b) const{
+        if(a.second != b.second){
+            return a.second < b.second;
+        }
+        return a.first > b.first;
+    }
+};
 
 
 Hashtable::Hashtable(bool debug, unsigned int probing){
@@ -46,9 +62,9 @@ Hashtable::~Hashtable(){
 void Hashtable::add(string k){
     //edge case
     if(k == ""){ return;}
-    //AVLTree mode
+    //AVLTree mode, finds or inserts k and increments it in one walk down the tree
     if(mode == 3){
-        avl->insert(make_pair(k, count(k)+1));
+        avl->upsert(k, [](int& value){ value++; });
         return;
     }
 
@@ -105,10 +121,11 @@ void Hashtable::resize(){
 int Hashtable::count(string k){
     //AVLTree mode
     if(mode == 3){
-        if(avl->find(k) == avl->end()){
+        AVLTree<string, int>::iterator it = avl->find(k);
+        if(it == avl->end()){
             return 0;
         }
-        return (*(avl->find(k))).second;
+        return it->second;
     }
 
     int pos = findAddIndex(k);
@@ -173,6 +190,25 @@ void Hashtable::reportAll(ostream& stream) const{
     }
 }
 
+/**
+ * Returns the k most frequent words and their counts, most frequent first
+ * Every entry goes through a size-k TopK selector, so this is O(n log k) instead of sorting everything
+ * */
+vector<pair<string, int> > Hashtable::topK(int k) const{
+    TopK<pair<string, int>, CountLess> selector(k);
+    //is AVLTree
+    if(mode == 3){
+        selector.offer(avl->begin(), avl->end());
+    } else {
+        for(int i = 0 ; i < PRIME_SIZES[size_index] ; i++){
+            if(data[i].first != ""){
+                selector.offer(data[i]);
+            }
+        }
+    }
+    return selector.extract();
+}
+
 /**
  * Hash helper: takes in a string and breaks it down into an int array of size 5
  * This is used by both the hash functions
@@ -1,5 +1,6 @@
 #include <string>
 #include <iostream>
+#include <vector>
 #include "../AVLTree/avlbst.h"
 
 using namespace std;
@@ -11,6 +12,8 @@ class Hashtable{
         int count(string k);
         //prints out all key value pairs to the ostream
         void reportAll(ostream& stream) const;
+        //returns the k words with the highest counts, highest first
+        vector<pair<string, int> > topK(int k) const;
     private:
         //load factor
         double load_factor;
@@ -0,0 +1,96 @@
+#include "Hashtable.h"
+#include <map>
+#include <algorithm>
+
+/**
+ * Counts, topK and reportAll of every mode (0-2: linear, quadratic, double hashing probing,
+ * 3: AVLTree) against the same words counted in a std::map
+ * returns the number of failed checks
+ * */
+int modeTest(unsigned int mode){
+    int failed = 0;
+    Hashtable table(true, mode);
+    map<string, int> expected;
+    //cherry 5, apple and banana tied at 3, date 1
+    const char* words[] = {"cherry", "apple", "banana", "cherry", "date", "banana", "cherry", "apple", "cherry", "banana", "apple", "cherry"};
+    for(unsigned int i = 0 ; i < sizeof(words) / sizeof(words[0]) ; i++){
+        table.add(words[i]);
+        expected[words[i]]++;
+    }
+    //enough distinct words to resize the probing tables a few times, each added i % 7 + 1 times
+    for(int i = 0 ; i < 300 ; i++){
+        string word = "w";
+        for(int n = i ; n > 0 ; n /= 26){
+            word += (char)('a' + n % 26);
+        }
+        for(int j = 0 ; j <= i % 7 ; j++){
+            table.add(word);
+            expected[word]++;
+        }
+    }
+    for(map<string, int>::iterator it = expected.begin() ; it != expected.end() ; ++it){
+        if(table.count(it->first) != it->second){ failed++; }
+    }
+    if(table.count("missing") != 0){ failed++; }
+
+    //all of them, most frequent first and ties alphabetical
+    vector<pair<string, int> > all(expected.begin(), expected.end());
+    stable_sort(all.begin(), all.end(), [](const pair<string, int>& a, const pair<string, int>& b){ return a.second > b.second; });
+    if(table.topK(expected.size() + 10) != all){ failed++; }
+    if(table.topK(3) != vector<pair<string, int> >(all.begin(), all.begin() + 3)){ failed++; }
+    if(!table.topK(0).empty()){ failed++; }
+    return failed;
+}
+
+/**
+ * A tie decided by the word: of apple and banana (both 2) only apple makes the top 2
+ * */
+int tieTest(unsigned int mode){
+    Hashtable table(true, mode);
+    const char* words[] = {"banana", "cherry", "apple", "cherry", "banana", "apple", "cherry"};
+    for(unsigned int i = 0 ; i < sizeof(words) / sizeof(words[0]) ; i++){
+        table.add(words[i]);
+    }
+    vector<pair<string, int> > wanted;
+    wanted.push_back(make_pair("cherry", 3));
+    wanted.push_back(make_pair("apple", 2));
+    return table.topK(2) == wanted ? 0 : 1;
+}
+
+/**
+ * One word added over and over between others: the first add counts 1 and every add after
+ * that one more (in AVLTree mode that is upsert on the same node), and it stays one item
+ * returns the number of failed checks
+ * */
+int repeatTest(unsigned int mode){
+    int failed = 0;
+    Hashtable table(true, mode);
+    table.add("again");
+    if(table.count("again") != 1){ failed++; }
+    for(int i = 2 ; i <= 1000 ; i++){
+        table.add("again");
+        if(i % 10 == 0){
+            table.add("other" + to_string(i));
+        }
+    }
+    if(table.count("again") != 1000 || table.count("other10") != 1){ failed++; }
+    vector<pair<string, int> > all = table.topK(1000);
+    int found = 0;
+    for(size_t i = 0 ; i < all.size() ; i++){
+        if(all[i].first == "again"){ found++; }
+    }
+    if(all.size() != 101 || found != 1 || all[0] != make_pair(string("again"), 1000)){ failed++; }
+    return failed;
+}
+
+int main(){
+    const char* names[] = {"linear probing", "quadratic probing", "double hashing", "AVL tree"};
+    for(unsigned int mode = 0 ; mode < 4 ; mode++){
+        if(modeTest(mode) != 0 || tieTest(mode) != 0 || repeatTest(mode) != 0){
+            cout << "FAILED: " << names[mode] << " mode" << endl;
+            return 1;
+        }
+        cout << names[mode] << " mode passed" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,529 @@
+#include "heap.h"
+#include "heap.cpp"
+#include "indexedheap.h"
+#include "indexedheap.cpp"
+#include "multiqueue.h"
+#include "multiqueue.cpp"
+#include "radixheap.h"
+#include "radixheap.cpp"
+#include "pairingheap.h"
+#include "pairingheap.cpp"
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * Counts hardware cache misses of the calling thread with perf_event_open
+ * Without perf events (not Linux, perf_event_paranoid too strict, VM without a PMU) every reading is -1
+ * */
+class CacheMissCounter{
+    public:
+        CacheMissCounter(){
+            fd = -1;
+#ifdef __linux__
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+        ~CacheMissCounter(){
+#ifdef __linux__
+            if(fd != -1){ close(fd); }
+#endif
+        }
+        bool available() const{
+            return fd != -1;
+        }
+        void start(){
+#ifdef __linux__
+            if(fd == -1){ return; }
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+        //misses since start(), -1 if not available
+        long long stop(){
+#ifdef __linux__
+            if(fd == -1){ return -1; }
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count;
+            if(read(fd, &count, sizeof(count)) != sizeof(count)){ return -1; }
+            return count;
+#else
+            return -1;
+#endif
+        }
+    private:
+        int fd;
+};
+
+/**
+ * Times a block of operations, counts its cache misses, and turns both into per-operation numbers
+ * */
+class Measurement{
+    public:
+        Measurement(CacheMissCounter& counter) : counter(counter){
+            nsPerOp = 0;
+            missesPerOp = -1;
+        }
+        void start(){
+            counter.start();
+            begin = chrono::steady_clock::now();
+        }
+        void stop(long long ops){
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count();
+            long long misses = counter.stop();
+            nsPerOp = ns / ops;
+            missesPerOp = misses < 0 ? -1 : (double)misses / ops;
+        }
+        double nsPerOp;
+        //-1 if cache misses could not be counted
+        double missesPerOp;
+    private:
+        CacheMissCounter& counter;
+        chrono::steady_clock::time_point begin;
+};
+
+/**
+ * Every result is one row of a single CSV table, so runs from different commits can be diffed
+ * An empty cache_misses_per_op means perf events were not available
+ * */
+class CsvReport{
+    public:
+        CsvReport(ostream& out) : out(out){
+            out << "suite,structure,type,distribution,n,threads,op,ns_per_op,cache_misses_per_op" << endl;
+        }
+        void row(const string& suite, const string& structure, const string& type, const string& distribution,
+                 long long n, int threads, const string& op, const Measurement& m){
+            out << suite << "," << structure << "," << type << "," << distribution << "," << n << ","
+                << threads << "," << op << "," << m.nsPerOp << ",";
+            if(m.missesPerOp >= 0){
+                out << m.missesPerOp;
+            }
+            out << endl;
+        }
+    private:
+        ostream& out;
+};
+
+//16 byte payload, compared by key only
+struct Item16{
+    long long key;
+    long long payload;
+    bool operator<(const Item16& other) const{ return key < other.key; }
+    bool operator>(const Item16& other) const{ return key > other.key; }
+};
+
+//turns a generated key into each element type
+template<class T> T makeElement(long long key);
+template<> int makeElement<int>(long long key){
+    return (int)key;
+}
+template<> Item16 makeElement<Item16>(long long key){
+    Item16 item = {key, key};
+    return item;
+}
+template<> string makeElement<string>(long long key){
+    //zero padded so that string order is number order, and long enough to not fit the small string buffer
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "key_%020lld", key);
+    return string(buffer);
+}
+
+const char* DISTRIBUTIONS[4] = {"random", "sorted", "reverse", "duplicates"};
+
+/**
+ * n keys in the given order: 0 random, 1 already sorted, 2 reverse sorted, 3 random with only 16 distinct values
+ * */
+vector<long long> makeKeys(long long n, int distribution){
+    vector<long long> keys(n);
+    mt19937_64 rng(104 + n);
+    for(long long i = 0 ; i < n ; i++){
+        if(distribution == 0){
+            keys[i] = rng() % 1000000000;
+        } else if(distribution == 1){
+            keys[i] = i;
+        } else if(distribution == 2){
+            keys[i] = n - i;
+        } else {
+            keys[i] = rng() % 16;
+        }
+    }
+    return keys;
+}
+
+/**
+ * push, push-pop, pop and (if heapify is given) heapify on structure H for one type, distribution and size
+ * Small sizes are repeated on separate heaps so every measurement covers at least about 1M operations
+ * */
+template<class H, class T>
+void microRun(CsvReport& report, CacheMissCounter& counter, const string& structure, const string& type,
+              int distribution, long long n, void (*heapify)(const vector<T>&)){
+    vector<T> items;
+    {
+        vector<long long> keys = makeKeys(n, distribution);
+        items.reserve(n);
+        for(long long i = 0 ; i < n ; i++){
+            items.push_back(makeElement<T>(keys[i]));
+        }
+    }
+    long long reps = 1000000 / n;
+    if(reps < 1){ reps = 1; }
+    const char* dist = DISTRIBUTIONS[distribution];
+    Measurement m(counter);
+
+    //fill empty heaps
+    vector<H> heaps(reps);
+    m.start();
+    for(long long r = 0 ; r < reps ; r++){
+        for(long long i = 0 ; i < n ; i++){
+            heaps[r].push(items[i]);
+        }
+    }
+    m.stop(reps * n);
+    report.row("micro", structure, type, dist, n, 1, "push", m);
+
+    //steady state: every push is followed by a pop, so the heaps stay at n items
+    m.start();
+    for(long long r = 0 ; r < reps ; r++){
+        for(long long i = n-1 ; i >= 0 ; i--){
+            heaps[r].push(items[i]);
+            heaps[r].pop();
+        }
+    }
+    m.stop(reps * n * 2);
+    report.row("micro", structure, type, dist, n, 1, "pushpop", m);
+
+    //drain the heaps
+    m.start();
+    for(long long r = 0 ; r < reps ; r++){
+        while(heaps[r].size() > 0){
+            heaps[r].pop();
+        }
+    }
+    m.stop(reps * n);
+    report.row("micro", structure, type, dist, n, 1, "pop", m);
+    heaps.clear();
+
+    if(heapify){
+        m.start();
+        for(long long r = 0 ; r < reps ; r++){
+            heapify(items);
+        }
+        m.stop(reps * n);
+        report.row("micro", structure, type, dist, n, 1, "heapify", m);
+    }
+}
+
+//builds a heap from items in one go, pairing heaps have no such constructor
+template<class H, class T>
+void buildHeap(const vector<T>& items){
+    H built(items.begin(), items.end());
+    if(built.size() != (int)items.size()){
+        cerr << "ERROR: heapify lost items" << endl;
+    }
+}
+
+/**
+ * Every structure and distribution for one element type, at sizes minSize, 10*minSize, ... up to maxSize
+ * */
+template<class T>
+void microType(CsvReport& report, CacheMissCounter& counter, const string& type, long long minSize, long long maxSize){
+    for(long long n = minSize ; n <= maxSize ; n *= 10){
+        for(int distribution = 0 ; distribution < 4 ; distribution++){
+            microRun<Heap<T, 2>, T>(report, counter, "heap2", type, distribution, n, buildHeap<Heap<T, 2>, T>);
+            microRun<Heap<T, 4>, T>(report, counter, "heap4", type, distribution, n, buildHeap<Heap<T, 4>, T>);
+            microRun<Heap<T, 8>, T>(report, counter, "heap8", type, distribution, n, buildHeap<Heap<T, 8>, T>);
+            microRun<PairingHeap<T>, T>(report, counter, "pairing", type, distribution, n, NULL);
+        }
+    }
+}
+
+/**
+ * Dijkstra from the corner of a width x width grid graph with random (directed) edge weights
+ * Returns the sum of all distances (so the versions can be checked against each other)
+ * maxSize is set to the largest the heap got
+ * */
+long long dijkstraLazy(int width, const vector<int>& weight, int& maxSize){
+    int n = width*width;
+    vector<long long> dist(n, -1);
+    vector<bool> done(n, false);
+    Heap<pair<long long, int> > h;
+    h.push(make_pair(0LL, 0));
+    dist[0] = 0;
+    maxSize = 1;
+    long long total = 0;
+    while(h.size() > 0){
+        pair<long long, int> curr = h.pop();
+        int u = curr.second;
+        //stale duplicate, u was already finished with a shorter distance
+        if(done[u]){ continue; }
+        done[u] = true;
+        total += curr.first;
+        int neighbors[4] = {u-width, u+width, u%width == 0 ? -1 : u-1, u%width == width-1 ? -1 : u+1};
+        for(int i = 0 ; i < 4 ; i++){
+            int v = neighbors[i];
+            if(v < 0 || v >= n || done[v]){ continue; }
+            long long d = curr.first + weight[u*4 + i];
+            if(dist[v] == -1 || d < dist[v]){
+                dist[v] = d;
+                h.push(make_pair(d, v));
+                if(h.size() > maxSize){ maxSize = h.size(); }
+            }
+        }
+    }
+    return total;
+}
+
+long long dijkstraIndexed(int width, const vector<int>& weight, int& maxSize){
+    int n = width*width;
+    vector<long long> dist(n, -1);
+    IndexedHeap<long long> h(n);
+    h.push(0, 0);
+    dist[0] = 0;
+    maxSize = 1;
+    long long total = 0;
+    while(!h.empty()){
+        long long du = h.top();
+        int u = h.pop();
+        total += du;
+        int neighbors[4] = {u-width, u+width, u%width == 0 ? -1 : u-1, u%width == width-1 ? -1 : u+1};
+        for(int i = 0 ; i < 4 ; i++){
+            int v = neighbors[i];
+            if(v < 0 || v >= n){ continue; }
+            long long d = du + weight[u*4 + i];
+            if(dist[v] == -1){
+                dist[v] = d;
+                h.push(v, d);
+                if(h.size() > maxSize){ maxSize = h.size(); }
+            } else if(d < dist[v] && h.contains(v)){
+                dist[v] = d;
+                h.decreaseKey(v, d);
+            }
+        }
+    }
+    return total;
+}
+
+//same as dijkstraLazy, with a radix heap since popped distances never decrease
+long long dijkstraRadix(int width, const vector<int>& weight, int& maxSize){
+    int n = width*width;
+    vector<long long> dist(n, -1);
+    vector<bool> done(n, false);
+    RadixHeap<unsigned long long, int> h;
+    h.push(0, 0);
+    dist[0] = 0;
+    maxSize = 1;
+    long long total = 0;
+    while(!h.empty()){
+        pair<unsigned long long, int> curr = h.pop();
+        int u = curr.second;
+        if(done[u]){ continue; }
+        done[u] = true;
+        total += curr.first;
+        int neighbors[4] = {u-width, u+width, u%width == 0 ? -1 : u-1, u%width == width-1 ? -1 : u+1};
+        for(int i = 0 ; i < 4 ; i++){
+            int v = neighbors[i];
+            if(v < 0 || v >= n || done[v]){ continue; }
+            long long d = curr.first + weight[u*4 + i];
+            if(dist[v] == -1 || d < dist[v]){
+                dist[v] = d;
+                h.push(d, v);
+                if(h.size() > maxSize){ maxSize = h.size(); }
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * Indexed heap with decreaseKey vs pushing duplicates and skipping stale entries (comparison and radix heap)
+ * Reported per grid node
+ * */
+void runDijkstra(CsvReport& report, CacheMissCounter& counter, int width){
+    mt19937 rng(104);
+    //weight[u*4 + i] is the weight of u's i-th edge
+    vector<int> weight(width*width*4);
+    for(unsigned int i = 0 ; i < weight.size() ; i++){
+        weight[i] = 1 + rng() % 100;
+    }
+    const char* names[3] = {"lazy_heap", "indexed_heap", "radix_heap"};
+    long long totals[3] = {0, 0, 0};
+    Measurement m(counter);
+    for(int version = 0 ; version < 3 ; version++){
+        int maxSize;
+        m.start();
+        if(version == 0){
+            totals[version] = dijkstraLazy(width, weight, maxSize);
+        } else if(version == 1){
+            totals[version] = dijkstraIndexed(width, weight, maxSize);
+        } else {
+            totals[version] = dijkstraRadix(width, weight, maxSize);
+        }
+        m.stop(width*width);
+        report.row("dijkstra", names[version], "grid", "random", width*width, 1, "node", m);
+    }
+    if(totals[0] != totals[1] || totals[0] != totals[2]){
+        cerr << "ERROR: dijkstra versions found different distances" << endl;
+    }
+}
+
+/**
+ * Every thread alternates push and pop of random keys on a queue prefilled with prefill items
+ * mode 0: one Heap behind one mutex, 1: relaxed MultiQueue, 2: strict MultiQueue
+ * returns wall clock ns per operation, over all threads
+ * */
+double concurrentRun(int mode, int threads, int opsPerThread, int prefill){
+    Heap<int, 4> locked;
+    std::mutex lock;
+    MultiQueue<int> mq(threads, 2, mode == 2);
+    mt19937 rng(104);
+    for(int i = 0 ; i < prefill ; i++){
+        if(mode == 0){
+            locked.push(rng());
+        } else {
+            mq.push(rng());
+        }
+    }
+    vector<thread> workers;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int t = 0 ; t < threads ; t++){
+        workers.push_back(thread([&, t](){
+            mt19937 local(t);
+            int popped;
+            for(int i = 0 ; i < opsPerThread ; i++){
+                if(i % 2 == 0){
+                    if(mode == 0){
+                        std::lock_guard<std::mutex> guard(lock);
+                        locked.push(local());
+                    } else {
+                        mq.push(local());
+                    }
+                } else {
+                    if(mode == 0){
+                        std::lock_guard<std::mutex> guard(lock);
+                        if(locked.size() > 0){ popped = locked.pop(); }
+                    } else {
+                        mq.tryPop(popped);
+                    }
+                }
+            }
+        }));
+    }
+    for(unsigned int i = 0 ; i < workers.size() ; i++){
+        workers[i].join();
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    return ns / ((double)threads * opsPerThread);
+}
+
+/**
+ * Throughput of the concurrent queues at 1 to 32 threads
+ * The counter only sees the calling thread, so no cache misses are reported here
+ * */
+void runConcurrent(CsvReport& report, CacheMissCounter& counter, int opsPerThread){
+    const char* names[3] = {"mutex_heap", "multiqueue", "multiqueue_strict"};
+    Measurement m(counter);
+    for(int mode = 0 ; mode < 3 ; mode++){
+        for(int threads = 1 ; threads <= 32 ; threads *= 2){
+            m.nsPerOp = concurrentRun(mode, threads, opsPerThread, 100000);
+            report.row("concurrent", names[mode], "int", "random", 100000, threads, "pushpop", m);
+        }
+    }
+}
+
+void usage(){
+    cerr << "usage: ./bench [--suite all|micro|dijkstra|concurrent] [--min-size N] [--max-size N]" << endl
+         << "               [--grid-width N] [--ops-per-thread N] [--csv FILE]" << endl
+         << "micro sizes go from --min-size to --max-size by factors of 10 (default 1000 to 10000000;" << endl
+         << "100000000 needs several GB of memory). string elements stop at 1000000" << endl;
+}
+
+/**
+ * Heap benchmarks, written as one CSV table to stdout (or --csv FILE)
+ * micro: push, pop, push-pop and heapify of 2/4/8-ary heaps and the pairing heap
+ *        for int, 16 byte struct and string elements, 4 key distributions and growing sizes
+ * dijkstra: decreaseKey vs lazy deletion vs radix heap on a grid graph
+ * concurrent: MultiQueue vs one locked heap at 1 to 32 threads
+ * */
+int main(int argc, char* argv[]){
+    string suite = "all";
+    long long minSize = 1000;
+    long long maxSize = 10000000;
+    int width = 1000;
+    int opsPerThread = 1000000;
+    string csvFile = "";
+    for(int i = 1 ; i < argc ; i += 2){
+        string arg = argv[i];
+        if(i+1 >= argc){
+            usage();
+            return 1;
+        }
+        if(arg == "--suite"){
+            suite = argv[i+1];
+        } else if(arg == "--min-size"){
+            minSize = atoll(argv[i+1]);
+        } else if(arg == "--max-size"){
+            maxSize = atoll(argv[i+1]);
+        } else if(arg == "--grid-width"){
+            width = atoi(argv[i+1]);
+        } else if(arg == "--ops-per-thread"){
+            opsPerThread = atoi(argv[i+1]);
+        } else if(arg == "--csv"){
+            csvFile = argv[i+1];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if(minSize < 1){ minSize = 1; }
+
+    ofstream file;
+    if(csvFile != ""){
+        file.open(csvFile.c_str());
+        if(!file){
+            cerr << "Could not open " << csvFile << endl;
+            return 1;
+        }
+    }
+    CsvReport report(csvFile != "" ? (ostream&)file : cout);
+    CacheMissCounter counter;
+    if(!counter.available()){
+        cerr << "perf_event_open is not available, cache_misses_per_op will be empty" << endl;
+    }
+
+    if(suite == "all" || suite == "micro"){
+        microType<int>(report, counter, "int", minSize, maxSize);
+        microType<Item16>(report, counter, "item16", minSize, maxSize);
+        microType<string>(report, counter, "string", minSize, min(maxSize, 1000000LL));
+    }
+    if(suite == "all" || suite == "dijkstra"){
+        runDijkstra(report, counter, width);
+    }
+    if(suite == "all" || suite == "concurrent"){
+        runConcurrent(report, counter, opsPerThread);
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+#ifndef EXTERNALHEAP_CPP
+#define EXTERNALHEAP_CPP
+#include "externalheap.h"
+#include "heap.cpp"
+#include <stdexcept>
+
+//the runs of a level are merged into one run of the next level when there are this many, which keeps
+//open files and the run heap small
+const int EXTERNAL_HEAP_MAX_RUNS = 64;
+
+
+//Constructor
+template <class T, class Compare>
+ExternalHeap<T, Compare>::ExternalHeap(int memoryItems, int bufferItems, const Compare& comp) :
+    HeapCompare<Compare>(comp), memory(comp), runs(RunCompare{&this->compare()}){
+    if(memoryItems < 1){ memoryItems = 1; }
+    if(bufferItems < 1){ bufferItems = 1; }
+    this->memoryItems = memoryItems;
+    this->bufferItems = bufferItems;
+    count = 0;
+}
+
+//Destructor: closing a tmpfile deletes it
+template <class T, class Compare>
+ExternalHeap<T, Compare>::~ExternalHeap(){
+    while(runs.size() > 0){
+        closeRun(runs.pop());
+    }
+}
+
+template <class T, class Compare>
+long long ExternalHeap<T, Compare>::size() const{
+    return count;
+}
+
+template <class T, class Compare>
+bool ExternalHeap<T, Compare>::empty() const{
+    return count == 0;
+}
+
+template <class T, class Compare>
+int ExternalHeap<T, Compare>::runCount() const{
+    return runs.size();
+}
+
+/**
+ * Helper function: a run backed by a new temporary file, which is deleted when it is closed
+ * */
+template <class T, class Compare>
+typename ExternalHeap<T, Compare>::Run* ExternalHeap<T, Compare>::newRun(int level){
+    FILE* file = tmpfile();
+    if(file == NULL){
+        throw std::runtime_error("ExternalHeap could not create a temporary file");
+    }
+    Run* run = new Run();
+    run->file = file;
+    run->pos = 0;
+    run->left = 0;
+    run->level = level;
+    if((int)runsPerLevel.size() <= level){
+        runsPerLevel.resize(level + 1, 0);
+    }
+    runsPerLevel[level]++;
+    return run;
+}
+
+/**
+ * Helper function: closing the file deletes it
+ * */
+template <class T, class Compare>
+void ExternalHeap<T, Compare>::closeRun(Run* run){
+    runsPerLevel[run->level]--;
+    fclose(run->file);
+    delete run;
+}
+
+/**
+ * Helper function: appends chunk to the run's file and empties chunk
+ * */
+template <class T, class Compare>
+void ExternalHeap<T, Compare>::writeChunk(Run* run, std::vector<T>& chunk){
+    if(fwrite(chunk.data(), sizeof(T), chunk.size(), run->file) != chunk.size()){
+        closeRun(run);
+        throw std::runtime_error("ExternalHeap could not write a run");
+    }
+    run->left += chunk.size();
+    chunk.clear();
+}
+
+/**
+ * Helper function: pops every in-memory item (so they come out sorted) into a new run
+ * runtime = M log(M) for M in-memory items, plus writing them
+ * */
+template <class T, class Compare>
+void ExternalHeap<T, Compare>::spill(){
+    Run* run = newRun(0);
+    std::vector<T> chunk;
+    chunk.reserve(bufferItems);
+    while(memory.size() > 0){
+        chunk.push_back(memory.pop());
+        if((int)chunk.size() == bufferItems || memory.size() == 0){
+            writeChunk(run, chunk);
+        }
+    }
+    rewind(run->file);
+    refill(run);
+    runs.push(run);
+    for(int level = 0 ; level < (int)runsPerLevel.size() && runsPerLevel[level] >= EXTERNAL_HEAP_MAX_RUNS ; level++){
+        mergeRuns(level);
+    }
+}
+
+/**
+ * Helper function: takes the runs of one level out of the heap of runs and does a multiway merge of
+ * them into a single run of the next level. The runs of other levels are left alone, so an item is
+ * only rewritten when its run is merged, at most once per level
+ * runtime = items in the level * log(EXTERNAL_HEAP_MAX_RUNS), plus runs * log(runs) to sort them out.
+ * With M in-memory items there are log(N / M) / log(EXTERNAL_HEAP_MAX_RUNS) levels, so the total
+ * amount written is N log(N / M) / log(EXTERNAL_HEAP_MAX_RUNS) for N pushes
+ * */
+template <class T, class Compare>
+void ExternalHeap<T, Compare>::mergeRuns(int level){
+    Heap<Run*, 2, RunCompare> tier(RunCompare{&this->compare()});
+    std::vector<Run*> others;
+    while(runs.size() > 0){
+        Run* run = runs.pop();
+        if(run->level == level){
+            tier.push(run);
+        } else {
+            others.push_back(run);
+        }
+    }
+    for(size_t i = 0 ; i < others.size() ; i++){
+        runs.push(others[i]);
+    }
+    Run* merged = newRun(level + 1);
+    std::vector<T> chunk;
+    chunk.reserve(bufferItems);
+    while(tier.size() > 0){
+        Run* run = tier.pop();
+        chunk.push_back(run->buffer[run->pos]);
+        run->pos++;
+        if(run->pos < (int)run->buffer.size() || refill(run)){
+            tier.push(run);
+        } else {
+            closeRun(run);
+        }
+        if((int)chunk.size() == bufferItems || tier.size() == 0){
+            writeChunk(merged, chunk);
+        }
+    }
+    rewind(merged->file);
+    refill(merged);
+    runs.push(merged);
+}
+
+/**
+ * Helper function: reads the next bufferItems items of a run
+ * */
+template <class T, class Compare>
+bool ExternalHeap<T, Compare>::refill(Run* run){
+    if(run->left == 0){
+        return false;
+    }
+    long long n = run->left < bufferItems ? run->left : bufferItems;
+    run->buffer.resize(n);
+    if(fread(run->buffer.data(), sizeof(T), n, run->file) != (size_t)n){
+        throw std::runtime_error("ExternalHeap could not read a run");
+    }
+    run->left -= n;
+    run->pos = 0;
+    return true;
+}
+
+/**
+ * Add item to the in-memory heap, spilling it to disk first if it is full
+ * runtime = log(M), plus M log(M) every M pushes for the spill
+ * */
+template <class T, class Compare>
+void ExternalHeap<T, Compare>::push(const T& item){
+    if(memory.size() >= memoryItems){
+        spill();
+    }
+    memory.push(item);
+    count++;
+}
+
+/**
+ * Helper function: the best item is either the in-memory top or the next item of the best run
+ * */
+template <class T, class Compare>
+bool ExternalHeap<T, Compare>::fromRuns() const{
+    if(runs.size() == 0){ return false; }
+    if(memory.size() == 0){ return true; }
+    const Run* run = runs.top();
+    return this->compare()(run->buffer[run->pos], memory.top());
+}
+
+/**
+ * Get topmost value
+ * runtime = const
+ * */
+template <class T, class Compare>
+const T& ExternalHeap<T, Compare>::top() const{
+    if(count == 0){
+        throw emptyHeadException();
+    }
+    if(fromRuns()){
+        const Run* run = runs.top();
+        return run->buffer[run->pos];
+    }
+    return memory.top();
+}
+
+/**
+ * Pop off the top value, from memory or from the best run. A run that moved past its buffer is
+ * refilled and put back in the heap of runs (or closed if it is used up)
+ * runtime = log(M) + log(runs), plus a buffered read every bufferItems items of a run
+ * */
+template <class T, class Compare>
+T ExternalHeap<T, Compare>::pop(){
+    if(count == 0){
+        throw emptyHeadException();
+    }
+    count--;
+    if(!fromRuns()){
+        return memory.pop();
+    }
+    Run* run = runs.pop();
+    T result = run->buffer[run->pos];
+    run->pos++;
+    if(run->pos < (int)run->buffer.size() || refill(run)){
+        runs.push(run);
+    } else {
+        closeRun(run);
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef EXTERNALHEAP_H
+#define EXTERNALHEAP_H
+#include <vector>
+#include <cstdio>
+#include <type_traits>
+#include "heap.h"
+
+//A MIN HEAP (with the same Compare rules as Heap) for more items than fit in memory
+//Up to memoryItems are kept in a Heap. When it is full, its items are written out in sorted order to a
+//temporary file (a run). pop takes the best of the in-memory top and the next item of every run,
+//reading each run through a small buffer. Runs are merged in tiers: a spill is a level 0 run and once a level holds
+//EXTERNAL_HEAP_MAX_RUNS runs they are merged into one run of the next level, so every item is rewritten once per level. Items are written as raw bytes, so T must be trivially copyable
+template<class T, class Compare = std::less<T> >
+class ExternalHeap : private HeapCompare<Compare>{
+    static_assert(std::is_trivially_copyable<T>::value, "ExternalHeap writes items as raw bytes");
+    public:
+        //memoryItems: how many items to keep in memory, bufferItems: how many items to read from a run at a time
+        ExternalHeap(int memoryItems = 1 << 20, int bufferItems = 4096, const Compare& comp = Compare());
+        ~ExternalHeap();
+        //add item to the heap, may write the in-memory items out to a new run
+        void push(const T& item);
+        //get the top element
+        const T& top() const;
+        //remove the topmost element and return it
+        T pop();
+        long long size() const;
+        bool empty() const;
+        //number of runs currently on disk
+        int runCount() const;
+    private:
+        //a sorted temporary file and the part of it that has been read in
+        struct Run{
+            FILE* file;
+            std::vector<T> buffer;
+            //next item to hand out from buffer
+            int pos;
+            //items still in the file after buffer
+            long long left;
+            //0 for a spill, one more than the runs it was merged from
+            int level;
+        };
+        //orders runs by their next item, for the heap of runs
+        struct RunCompare{
+            const Compare* comp;
+            bool operator()(const Run* a, const Run* b) const{ return (*comp)(a->buffer[a->pos], b->buffer[b->pos]); }
+        };
+        Heap<T, 4, Compare> memory;
+        //runs that still have items, the run with the best next item on top
+        Heap<Run*, 2, RunCompare> runs;
+        //how many open runs each level has
+        std::vector<int> runsPerLevel;
+        int memoryItems;
+        int bufferItems;
+        long long count;
+
+        //no copying, runs own files
+        ExternalHeap(const ExternalHeap& other);
+        ExternalHeap& operator=(const ExternalHeap& other);
+
+        //write every in-memory item to a new run
+        void spill();
+        //merge every run of level into one run of the next level, so the number of open files stays bounded
+        void mergeRuns(int level);
+        //a new temporary file of the given level opened for writing a run
+        Run* newRun(int level);
+        //close and delete a run that is used up (or no longer needed)
+        void closeRun(Run* run);
+        //write items to the end of run's file
+        void writeChunk(Run* run, std::vector<T>& chunk);
+        //refill a run's buffer from its file, returns false if the run is used up
+        bool refill(Run* run);
+        //true if the next item comes from the runs instead of memory
+        bool fromRuns() const;
+};
+
+#endif
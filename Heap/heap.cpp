@@ -1,3 +1,5 @@
+#ifndef HEAP_CPP
+#define HEAP_CPP
 #include "heap.h"
 #include <iostream>
 #include <list>
@@ -21,64 +23,87 @@ class emptyHeadException : public std::exception{
 
 
 //Default constructor
-template <class T>
-Heap<T>::Heap(){
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>::Heap(const Compare& comp) : HeapCompare<Compare>(comp){
     data = {};
 }
 
 //Copy constructor
-template <class T>
-Heap<T>::Heap(const Heap& other){
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>::Heap(const Heap& other) : HeapCompare<Compare>(other.compare()){
     data = other.data;
 }
 
-// //constructor with a list ADT
-// template <class T>
-// Heap<T>::Heap(const list<T>& lst){
-//     data = {};
-//     int counter = 0;
-//     for(list<T>::iterator it = lst.start() ; it != lst.end() ; it++){
-//         data.push_back(*it);
-//     }
-// }
+//Constructor with a range (works for a list ADT too)
+template <class T, unsigned int D, class Compare>
+template <class InputIt, class>
+Heap<T, D, Compare>::Heap(InputIt first, InputIt last, const Compare& comp) : HeapCompare<Compare>(comp){
+    data.assign(first, last);
+    heapify();
+}
+
+//Constructor with a vector
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>::Heap(const std::vector<T>& items, const Compare& comp) : HeapCompare<Compare>(comp){
+    data.assign(items.begin(), items.end());
+    heapify();
+}
+
+//Move constructor
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>::Heap(Heap&& other) : HeapCompare<Compare>(other.compare()){
+    data = std::move(other.data);
+}
 
 //Assign operator
-template <class T>
-Heap<T>& Heap<T>::operator=(const Heap& other){
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>& Heap<T, D, Compare>::operator=(const Heap& other){
     //check for self assignment
     if(&other == this){ return *this; }
+    HeapCompare<Compare>::operator=(other);
     data = other.data;
+    return *this;
+}
+
+//Move assign operator
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>& Heap<T, D, Compare>::operator=(Heap&& other){
+    //check for self assignment
+    if(&other == this){ return *this; }
+    HeapCompare<Compare>::operator=(other);
+    data = std::move(other.data);
+    return *this;
 }
 
 //Destructor
-template <class T>
-Heap<T>::~Heap(){
+template <class T, unsigned int D, class Compare>
+Heap<T, D, Compare>::~Heap(){
 }
 
-template <class T>
-int Heap<T>::size(){
+template <class T, unsigned int D, class Compare>
+int Heap<T, D, Compare>::size() const{
     return data.size();
 }
 
 /**
  * Helper function: returns the index of the parent function. -1 if none.
  * */
-template <class T>
-int Heap<T>::getParent(int x) const{
-    int ans = (x-1)/2;
-    if(ans < 0){
+template <class T, unsigned int D, class Compare>
+int Heap<T, D, Compare>::getParent(int x) const{
+    //the root has no parent ((0-1)/D would round to 0)
+    if(x == 0){
         return -1;
-    } else {
-        return ans;
     }
+    return (x-1)/D;
 }
 
 /**
- * Helper function: returns the index of the left child. -1 if none
+ * Helper function: returns the index of the first child. -1 if none
+ * The D children of x are stored next to each other, from getFirstChild(x) to getFirstChild(x)+D-1
  * */
-template <class T>
-int Heap<T>::getLChild(int x) const{
-    int ans = x*2 + 1;
+template <class T, unsigned int D, class Compare>
+int Heap<T, D, Compare>::getFirstChild(int x) const{
+    int ans = x*D + 1;
     if(ans >= (int)data.size()){
         return -1;
     } else {
@@ -86,66 +111,163 @@ int Heap<T>::getLChild(int x) const{
     }
 }
 
-/** 
- * Helper function: returns the index of the right child. -1 if none
+/**
+ * Helper function: the only place the heap compares items, everything goes through the comparator
  * */
-template <class T>
-int Heap<T>::getRChild(int x) const{
-    int ans = x*2 + 2;
-    if(ans >= (int)data.size()){
-        return -1;
-    } else {
-        return ans;
-    }
+template <class T, unsigned int D, class Compare>
+inline bool Heap<T, D, Compare>::before(const T& a, const T& b) const{
+    return this->compare()(a, b);
 }
 
 /**
- * Helper function: returns the index of the min child, -1 if leaf node
+ * Helper function: returns the index of the min child (the one closest to the top), -1 if leaf node
  * */
-template <class T>
-int Heap<T>::findMinChild(int index) const{
-    int lc = getLChild(index);
-    int rc = getRChild(index);
-    int min;
-    //only 1 element
-    if(lc == -1 && rc == -1) {return -1;}
-    //no right children
-    if(rc == -1){
-        min = lc;
-    //both children exist
-    } else {
-        if(data[lc] < data[rc]){ min = lc; }
-        else { min = rc; }
+template <class T, unsigned int D, class Compare>
+int Heap<T, D, Compare>::findMinChild(int index) const{
+    int first = getFirstChild(index);
+    //leaf node
+    if(first == -1) {return -1;}
+    int last = first + D;
+    //the last node may not have all D children
+    if(last > (int)data.size()){ last = data.size(); }
+    int min = first;
+    for(int c = first+1 ; c < last ; c++){
+        if(before(data[c], data[min])){ min = c; }
     }
     return min;
 }
 
 
 /**
- * Add new item to the heap and trickle up
- * runtime = log(n)
+ * Trickle up, hole style: the item is moved out once, every bigger parent is moved down one level
+ * into the hole, and the item is moved into the final hole. That is one move per level instead of a 3-copy swap
+ * runtime = log_D(n)
  * */
-template <class T>
-void Heap<T>::push(T item){
-    data.push_back(item);
-    //start the trickle up process
-    int index = data.size()-1;
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::siftUp(int index){
+    T item = std::move(data[index]);
     int parent = getParent(index);
-    while(parent != -1 && data[parent] > data[index]){
-        T temp = data[parent];
-        data[parent] = data[index];
-        data[index] = temp;
+    while(parent != -1 && before(item, data[parent])){
+        data[index] = std::move(data[parent]);
         index = parent;
         parent = getParent(index);
     }
+    data[index] = std::move(item);
+}
+
+/**
+ * Trickle down, hole style: same idea as siftUp, the smallest child moves up into the hole each level
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::siftDown(int index){
+    T item = std::move(data[index]);
+    int min = findMinChild(index);
+    while(min != -1 && before(data[min], item)){
+        data[index] = std::move(data[min]);
+        index = min;
+        min = findMinChild(index);
+    }
+    data[index] = std::move(item);
+}
+
+/**
+ * Add new item to the heap and trickle up
+ * runtime = log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::push(const T& item){
+    data.push_back(item);
+    siftUp(data.size()-1);
+}
+
+/**
+ * Same as push, but moves item into the heap instead of copying it
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::push(T&& item){
+    data.push_back(std::move(item));
+    siftUp(data.size()-1);
+}
+
+/**
+ * Same as push, but the item is constructed in place from args
+ * */
+template <class T, unsigned int D, class Compare>
+template <class... Args>
+void Heap<T, D, Compare>::emplace(Args&&... args){
+    data.emplace_back(std::forward<Args>(args)...);
+    siftUp(data.size()-1);
+}
+
+/**
+ * Add every item in the range
+ * runtime = min(k*log_D(n+k), n+k)
+ * */
+template <class T, unsigned int D, class Compare>
+template <class InputIt>
+void Heap<T, D, Compare>::pushRange(InputIt first, InputIt last){
+    std::size_t oldSize = data.size();
+    data.insert(data.end(), first, last);
+    fixAppended(data.size() - oldSize);
+}
+
+/**
+ * Moves all of other's items into this heap. The bigger heap's vector is kept, so only
+ * the smaller heap's items get moved, and then they are fixed up the same way as pushRange
+ * runtime = O(n+m)
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::merge(Heap&& other){
+    if(&other == this){ return; }
+    if(other.data.size() > data.size()){
+        data.swap(other.data);
+    }
+    std::size_t oldSize = data.size();
+    data.insert(data.end(), std::make_move_iterator(other.data.begin()), std::make_move_iterator(other.data.end()));
+    other.data.clear();
+    fixAppended(data.size() - oldSize);
+}
+
+/**
+ * Helper for pushRange and merge: the last `added` items of data are not in heap order yet.
+ * Sifting each one up costs up to log_D(n) moves, rebuilding the whole heap costs about n,
+ * so a batch that is large compared to the heap is fixed by heapify
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::fixAppended(int added){
+    int n = data.size();
+    int depth = 1;
+    for(long long levelEnd = D ; levelEnd < n ; levelEnd = levelEnd*D + D){
+        depth++;
+    }
+    if((long long)added * depth > n){
+        heapify();
+    } else {
+        for(int i = n - added ; i < n ; i++){
+            siftUp(i);
+        }
+    }
+}
+
+/**
+ * Floyd's bottom-up heap construction: trickle down every internal node starting from the last one.
+ * Most nodes are near the bottom and only move a level or two, so the total is O(n) instead of O(n log n)
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::heapify(){
+    if(data.size() < 2){ return; }
+    for(int i = getParent(data.size()-1) ; i >= 0 ; i--){
+        siftDown(i);
+    }
 }
 
 /**
  * Get topmost value
  * runtime = const
  **/
-template <class T>
-T Heap<T>::top() const{
+template <class T, unsigned int D, class Compare>
+const T& Heap<T, D, Compare>::top() const{
     //edge case: if heap is empty
     if(data.size() == 0){
         throw emptyHeadException();
@@ -155,39 +277,59 @@ T Heap<T>::top() const{
 }
 
 /**
- * Pop off the top value by swapping it with the last element and trickling down
- * runtime = log(n)
+ * Pop off the top value: it is moved out, the last element is moved into the root and trickled down
+ * Returns the old top
+ * runtime = D*log_D(n)
  * */
-template <class T>
-void Heap<T>::pop(){
+template <class T, unsigned int D, class Compare>
+T Heap<T, D, Compare>::pop(){
     //edge case: if heap is empty
     if(data.size() == 0){
         throw emptyHeadException();
     }
-    T temp = data[0];
-    data[0] = data[data.size()-1];
-    data[data.size()-1] = temp;
-    
-    data.pop_back();
-    //start trickle down
-    int index = 0;
-    int min = findMinChild(index);
-    while(min != -1 && data[index] > data[min]){
-        T temp = data[index];
-        data[index] = data[min];
-        data[min] = temp;
-        index = min;
-        min = findMinChild(index);
+    T result = std::move(data[0]);
+    if(data.size() > 1){
+        data[0] = std::move(data.back());
+        data.pop_back();
+        siftDown(0);
+    } else {
+        data.pop_back();
+    }
+    return result;
+}
+
+/**
+ * Overwrite the top with item and trickle it down. Only one sift instead of the two
+ * that pop and push would do
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::replaceTop(const T& item){
+    if(data.size() == 0){
+        throw emptyHeadException();
+    }
+    data[0] = item;
+    siftDown(0);
+}
+
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::replaceTop(T&& item){
+    if(data.size() == 0){
+        throw emptyHeadException();
     }
+    data[0] = std::move(item);
+    siftDown(0);
 }
 
 /**
  * Prints out the entire data vector
  * */
-template <class T>
-void Heap<T>::printHeap(){
+template <class T, unsigned int D, class Compare>
+void Heap<T, D, Compare>::printHeap(){
     for(unsigned int i = 0 ; i < data.size() ; i++){
         std::cout << data[i] << " ";
     }
     std::cout << std::endl;
-}
\ No newline at end of file
+}
+
+#endif
@@ -2,37 +2,129 @@
 #define HEAP_H
 #include <list>
 #include <vector>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <iterator>
 
-//THIS IS A MIN HEAP
+//size of a cache line on the machines we target
+const std::size_t HEAP_CACHE_LINE = 64;
+
+/**
+ * Allocator for the heap's vector. It shifts the buffer so that index 1 (the root's first child)
+ * starts on a cache line. Every group of siblings D*i+1 ... D*i+D then starts at a multiple of D*sizeof(T)
+ * from a line boundary, so when D*sizeof(T) divides or is a multiple of the line size (8 or 16 ints,
+ * 4 16-byte structs, ...) one level's siblings are read with the fewest possible cache lines
+ * */
 template<class T>
-class Heap{
+class HeapAllocator{
+    public:
+        typedef T value_type;
+        HeapAllocator(){}
+        template<class U>
+        HeapAllocator(const HeapAllocator<U>&){}
+        T* allocate(std::size_t n){
+            char* raw = (char*)::operator new(n*sizeof(T) + HEAP_CACHE_LINE, std::align_val_t(HEAP_CACHE_LINE));
+            return (T*)(raw + offset());
+        }
+        void deallocate(T* p, std::size_t){
+            ::operator delete((char*)p - offset(), std::align_val_t(HEAP_CACHE_LINE));
+        }
+        template<class U>
+        bool operator==(const HeapAllocator<U>&) const{ return true; }
+        template<class U>
+        bool operator!=(const HeapAllocator<U>&) const{ return false; }
+    private:
+        //distance of element 0 from the line boundary, so that element 1 lands on the boundary
+        static std::size_t offset(){
+            return (HEAP_CACHE_LINE - sizeof(T) % HEAP_CACHE_LINE) % HEAP_CACHE_LINE;
+        }
+};
+
+/**
+ * Holds the heap's comparator. Empty comparators (std::less, std::greater, most lambdas and key extractors)
+ * are inherited from instead of stored, so they take no space (empty base optimization), and calls to them inline
+ * */
+template<class Compare, bool Empty = std::is_empty<Compare>::value && !std::is_final<Compare>::value>
+class HeapCompare : private Compare{
+    public:
+        HeapCompare(const Compare& comp) : Compare(comp){}
+        const Compare& compare() const{ return *this; }
+};
+
+//comparators with state (or function pointers) are stored as a member
+template<class Compare>
+class HeapCompare<Compare, false>{
+    public:
+        HeapCompare(const Compare& comp) : comp_(comp){}
+        const Compare& compare() const{ return comp_; }
+    private:
+        Compare comp_;
+};
+
+//THIS IS A MIN HEAP by default: the top is the item that no other item compares less than
+//Compare(a, b) returns true if a belongs closer to the top than b, so std::greater<T> makes a max heap
+//D is the number of children per node (2 is a binary heap). 4 or 8 make the heap shallower
+//and a node's children sit in one cache line, which makes pop much cheaper on large heaps
+template<class T, unsigned int D = 2, class Compare = std::less<T> >
+class Heap : private HeapCompare<Compare>{
+    static_assert(D >= 2, "a heap needs at least 2 children per node");
     public:
         //default constructor
-        Heap();
-        //constructor with list
-        //Heap(const list<T>& lst);
+        Heap(const Compare& comp = Compare());
+        //constructor from any range of items (a list, another container, ...), heapified in O(n)
+        //only takes iterators, so Heap<int> h(4, 2) doesn't end up in here
+        template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+        Heap(InputIt first, InputIt last, const Compare& comp = Compare());
+        //constructor with vector, heapified in O(n)
+        Heap(const std::vector<T>& items, const Compare& comp = Compare());
         //copy contructor
         Heap(const Heap& other);
+        //move constructor
+        Heap(Heap&& other);
         //deconstructor
         ~Heap();
         //assignment operator
         Heap& operator=(const Heap& other);
+        //move assignment operator
+        Heap& operator=(Heap&& other);
         //add item to the heap
-        void push(T item);
+        void push(const T& item);
+        void push(T&& item);
+        //construct the item in place from args and add it to the heap
+        template<class... Args>
+        void emplace(Args&&... args);
+        //add all items in the range, re-heapifying everything if that is cheaper than pushing one by one
+        template<class InputIt>
+        void pushRange(InputIt first, InputIt last);
+        //move all of other's items into this heap in linear time, other is left empty
+        void merge(Heap&& other);
         //get the top element
-        T top() const;
-        //remove the topmost element
-        void pop();
+        const T& top() const;
+        //remove the topmost element and return it (moved out, not copied)
+        T pop();
+        //replace the topmost element with item, cheaper than pop followed by push
+        void replaceTop(const T& item);
+        void replaceTop(T&& item);
         void printHeap();
-        int size();
+        int size() const;
     private:
-        std::vector<T> data;
+        std::vector<T, HeapAllocator<T> > data;
         int getParent(int x) const;
-        int getLChild(int x) const;
-        int getRChild(int x) const;
+        int getFirstChild(int x) const;
+        //true if a belongs closer to the top than b
+        bool before(const T& a, const T& b) const;
         int findMinChild(int index) const;
+        //move the item at index up/down to where it belongs
+        void siftUp(int index);
+        void siftDown(int index);
+        //restore the heap after the last added items were appended to data
+        void fixAppended(int added);
+        void heapify();
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
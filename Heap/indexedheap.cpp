@@ -0,0 +1,242 @@
+#ifndef INDEXEDHEAP_CPP
+#define INDEXEDHEAP_CPP
+#include "indexedheap.h"
+#include "heap.cpp"
+#include <string>
+
+/**
+ * Customized exception to throw when a handle is used in a way that doesn't match the heap's contents
+ * */
+class indexedHeapException : public std::exception{
+    public:
+        indexedHeapException(const std::string& msg){
+            msg_ = msg;
+        }
+        virtual const char* what() const noexcept{
+            return msg_.c_str();
+        }
+    protected:
+        std::string msg_;
+};
+
+
+//Constructor
+template <class T, unsigned int D, class Compare>
+IndexedHeap<T, D, Compare>::IndexedHeap(int capacity, const Compare& comp) : HeapCompare<Compare>(comp){
+    pos.assign(capacity, -1);
+    data.reserve(capacity);
+}
+
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::size() const{
+    return data.size();
+}
+
+template <class T, unsigned int D, class Compare>
+bool IndexedHeap<T, D, Compare>::empty() const{
+    return data.size() == 0;
+}
+
+template <class T, unsigned int D, class Compare>
+bool IndexedHeap<T, D, Compare>::contains(int handle) const{
+    return handle >= 0 && handle < (int)pos.size() && pos[handle] != -1;
+}
+
+/**
+ * Helper function: returns the index of handle in data, throws if it isn't in the heap
+ * */
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::indexOf(int handle) const{
+    if(!contains(handle)){
+        throw indexedHeapException("Handle " + std::to_string(handle) + " is not in the heap");
+    }
+    return pos[handle];
+}
+
+template <class T, unsigned int D, class Compare>
+const T& IndexedHeap<T, D, Compare>::priority(int handle) const{
+    return data[indexOf(handle)].priority;
+}
+
+/**
+ * Helper function: returns the index of the parent. -1 if none.
+ * */
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::getParent(int x) const{
+    if(x == 0){
+        return -1;
+    }
+    return (x-1)/D;
+}
+
+/**
+ * Helper function: the only place priorities are compared
+ * */
+template <class T, unsigned int D, class Compare>
+inline bool IndexedHeap<T, D, Compare>::before(const T& a, const T& b) const{
+    return this->compare()(a, b);
+}
+
+/**
+ * Helper function: returns the index of the min child, -1 if leaf node
+ * */
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::findMinChild(int index) const{
+    int first = index*D + 1;
+    if(first >= (int)data.size()){ return -1; }
+    int last = first + D;
+    if(last > (int)data.size()){ last = data.size(); }
+    int min = first;
+    for(int c = first+1 ; c < last ; c++){
+        if(before(data[c].priority, data[min].priority)){ min = c; }
+    }
+    return min;
+}
+
+/**
+ * Hole-based trickle up, every entry that moves has its position updated
+ * runtime = log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::siftUp(int index){
+    Entry item = std::move(data[index]);
+    int parent = getParent(index);
+    while(parent != -1 && before(item.priority, data[parent].priority)){
+        data[index] = std::move(data[parent]);
+        pos[data[index].handle] = index;
+        index = parent;
+        parent = getParent(index);
+    }
+    pos[item.handle] = index;
+    data[index] = std::move(item);
+}
+
+/**
+ * Hole-based trickle down, every entry that moves has its position updated
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::siftDown(int index){
+    Entry item = std::move(data[index]);
+    int min = findMinChild(index);
+    while(min != -1 && before(data[min].priority, item.priority)){
+        data[index] = std::move(data[min]);
+        pos[data[index].handle] = index;
+        index = min;
+        min = findMinChild(index);
+    }
+    pos[item.handle] = index;
+    data[index] = std::move(item);
+}
+
+/**
+ * Add a new handle to the heap and trickle up
+ * runtime = log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::push(int handle, const T& priority){
+    if(handle < 0){
+        throw indexedHeapException("Handles can't be negative");
+    }
+    if(contains(handle)){
+        throw indexedHeapException("Handle " + std::to_string(handle) + " is already in the heap");
+    }
+    if(handle >= (int)pos.size()){
+        pos.resize(handle+1, -1);
+    }
+    Entry e = {priority, handle};
+    data.push_back(std::move(e));
+    siftUp(data.size()-1);
+}
+
+/**
+ * Get the handle of the topmost entry
+ * runtime = const
+ * */
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::topHandle() const{
+    if(data.size() == 0){
+        throw emptyHeadException();
+    }
+    return data[0].handle;
+}
+
+/**
+ * Get the priority of the topmost entry
+ * runtime = const
+ * */
+template <class T, unsigned int D, class Compare>
+const T& IndexedHeap<T, D, Compare>::top() const{
+    if(data.size() == 0){
+        throw emptyHeadException();
+    }
+    return data[0].priority;
+}
+
+/**
+ * Pop off the topmost entry and return its handle
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+int IndexedHeap<T, D, Compare>::pop(){
+    if(data.size() == 0){
+        throw emptyHeadException();
+    }
+    int handle = data[0].handle;
+    erase(handle);
+    return handle;
+}
+
+/**
+ * Change handle's priority to one closer to the top and trickle it up
+ * runtime = log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::decreaseKey(int handle, const T& priority){
+    int index = indexOf(handle);
+    if(before(data[index].priority, priority)){
+        throw indexedHeapException("decreaseKey can't move a handle away from the top");
+    }
+    data[index].priority = priority;
+    siftUp(index);
+}
+
+/**
+ * Change handle's priority to one further from the top and trickle it down
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::increaseKey(int handle, const T& priority){
+    int index = indexOf(handle);
+    if(before(priority, data[index].priority)){
+        throw indexedHeapException("increaseKey can't move a handle towards the top");
+    }
+    data[index].priority = priority;
+    siftDown(index);
+}
+
+/**
+ * Remove handle from the heap: the last entry is moved into its slot and trickled
+ * up or down, depending on which way it is out of order
+ * runtime = D*log_D(n)
+ * */
+template <class T, unsigned int D, class Compare>
+void IndexedHeap<T, D, Compare>::erase(int handle){
+    int index = indexOf(handle);
+    pos[handle] = -1;
+    int last = data.size()-1;
+    if(index != last){
+        data[index] = std::move(data[last]);
+        data.pop_back();
+        int parent = getParent(index);
+        if(parent != -1 && before(data[index].priority, data[parent].priority)){
+            siftUp(index);
+        } else {
+            siftDown(index);
+        }
+    } else {
+        data.pop_back();
+    }
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+#include <vector>
+#include "heap.h"
+
+//THIS IS A MIN HEAP of priorities by default, Compare works the same way as in Heap, where every item is named by an int handle (e.g. a graph vertex)
+//Knowing where each handle sits in the array lets its priority be changed or the item be removed in place,
+//so Dijkstra/A* don't need to push duplicates and skip stale entries
+template<class T, unsigned int D = 2, class Compare = std::less<T> >
+class IndexedHeap : private HeapCompare<Compare>{
+    static_assert(D >= 2, "a heap needs at least 2 children per node");
+    public:
+        //capacity is a hint for the largest handle + 1, the heap grows if a bigger handle is pushed
+        IndexedHeap(int capacity = 0, const Compare& comp = Compare());
+        //add handle with the given priority, handle can't already be in the heap
+        void push(int handle, const T& priority);
+        //true if handle is currently in the heap
+        bool contains(int handle) const;
+        //priority of a handle that is in the heap
+        const T& priority(int handle) const;
+        //handle and priority of the top element
+        int topHandle() const;
+        const T& top() const;
+        //remove the topmost element and return its handle
+        int pop();
+        //move a handle towards the top (decreaseKey) or the bottom (increaseKey) by changing its priority
+        void decreaseKey(int handle, const T& priority);
+        void increaseKey(int handle, const T& priority);
+        //remove a handle from the heap
+        void erase(int handle);
+        int size() const;
+        bool empty() const;
+    private:
+        struct Entry{
+            T priority;
+            int handle;
+        };
+        //entries in heap order, priorities are stored inline so comparisons don't jump around in memory
+        std::vector<Entry, HeapAllocator<Entry> > data;
+        //position of each handle in data, -1 if not in the heap
+        std::vector<int> pos;
+        int getParent(int x) const;
+        //true if a belongs closer to the top than b
+        bool before(const T& a, const T& b) const;
+        int findMinChild(int index) const;
+        //move the entry at index up/down to where it belongs, keeping pos up to date
+        void siftUp(int index);
+        void siftDown(int index);
+        //index of handle in data, throws if it isn't in the heap
+        int indexOf(int handle) const;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef MULTIQUEUE_CPP
+#define MULTIQUEUE_CPP
+#include "multiqueue.h"
+#include "heap.cpp"
+#include <random>
+#include <thread>
+#include <functional>
+
+
+//Constructor
+template <class T, unsigned int D, class Compare>
+MultiQueue<T, D, Compare>::MultiQueue(int threads, int c, bool strict, const Compare& comp) : HeapCompare<Compare>(comp){
+    int n = threads * c;
+    //need at least 2 shards to pick 2 different ones
+    if(n < 2){ n = 2; }
+    for(int i = 0 ; i < n ; i++){
+        shards.push_back(new Shard(comp));
+    }
+    count.store(0);
+    this->strict = strict;
+}
+
+//Destructor
+template <class T, unsigned int D, class Compare>
+MultiQueue<T, D, Compare>::~MultiQueue(){
+    for(unsigned int i = 0 ; i < shards.size() ; i++){
+        delete shards[i];
+    }
+}
+
+template <class T, unsigned int D, class Compare>
+int MultiQueue<T, D, Compare>::size() const{
+    return count.load();
+}
+
+template <class T, unsigned int D, class Compare>
+bool MultiQueue<T, D, Compare>::empty() const{
+    return count.load() == 0;
+}
+
+template <class T, unsigned int D, class Compare>
+bool MultiQueue<T, D, Compare>::isStrict() const{
+    return strict;
+}
+
+/**
+ * Helper function: random shard index from a per-thread generator, so picking a shard never touches shared state
+ * */
+template <class T, unsigned int D, class Compare>
+int MultiQueue<T, D, Compare>::randomShard() const{
+    static thread_local std::minstd_rand rng(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return rng() % shards.size();
+}
+
+/**
+ * Helper function: locks a random shard. Busy shards are skipped instead of waited on,
+ * after trying as many shards as there are the last one is waited on
+ * */
+template <class T, unsigned int D, class Compare>
+typename MultiQueue<T, D, Compare>::Shard* MultiQueue<T, D, Compare>::lockRandomShard(){
+    for(unsigned int attempt = 0 ; attempt < shards.size() ; attempt++){
+        Shard* s = shards[randomShard()];
+        if(s->lock.try_lock()){
+            return s;
+        }
+    }
+    Shard* s = shards[randomShard()];
+    s->lock.lock();
+    return s;
+}
+
+/**
+ * Add item to a random shard
+ * runtime = log(n/shards) plus the lock
+ * */
+template <class T, unsigned int D, class Compare>
+void MultiQueue<T, D, Compare>::push(const T& item){
+    Shard* s = lockRandomShard();
+    s->heap.push(item);
+    count.fetch_add(1);
+    s->lock.unlock();
+}
+
+template <class T, unsigned int D, class Compare>
+void MultiQueue<T, D, Compare>::push(T&& item){
+    Shard* s = lockRandomShard();
+    s->heap.push(std::move(item));
+    count.fetch_add(1);
+    s->lock.unlock();
+}
+
+template <class T, unsigned int D, class Compare>
+bool MultiQueue<T, D, Compare>::tryPop(T& out){
+    if(strict){
+        return tryPopStrict(out);
+    }
+    return tryPopRelaxed(out);
+}
+
+/**
+ * Relaxed pop: lock two random shards and pop the better of their tops
+ * If the sampled shards keep being busy or empty, every shard is checked in turn,
+ * so false is only returned when the whole queue was seen empty
+ * */
+template <class T, unsigned int D, class Compare>
+bool MultiQueue<T, D, Compare>::tryPopRelaxed(T& out){
+    int n = shards.size();
+    while(count.load() > 0){
+        for(int attempt = 0 ; attempt < n ; attempt++){
+            int i = randomShard();
+            int j = randomShard();
+            if(i == j){ j = (i+1) % n; }
+            //always lock the lower index first so two pops can't deadlock
+            if(i > j){ std::swap(i, j); }
+            Shard* a = shards[i];
+            Shard* b = shards[j];
+            if(!a->lock.try_lock()){ continue; }
+            if(!b->lock.try_lock()){
+                a->lock.unlock();
+                continue;
+            }
+            Shard* best = NULL;
+            if(a->heap.size() > 0){ best = a; }
+            if(b->heap.size() > 0 && (best == NULL || this->compare()(b->heap.top(), best->heap.top()))){
+                best = b;
+            }
+            if(best != NULL){
+                out = best->heap.pop();
+                count.fetch_sub(1);
+            }
+            a->lock.unlock();
+            b->lock.unlock();
+            if(best != NULL){ return true; }
+        }
+        //sampling missed, take from the first shard that has anything
+        for(int i = 0 ; i < n ; i++){
+            std::lock_guard<std::mutex> guard(shards[i]->lock);
+            if(shards[i]->heap.size() > 0){
+                out = shards[i]->heap.pop();
+                count.fetch_sub(1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Strict pop: lock every shard (in index order) and pop the best top of all of them.
+ * While all locks are held no push or pop can happen, so this is the exact top at that moment
+ * runtime = shards + log(n/shards)
+ * */
+template <class T, unsigned int D, class Compare>
+bool MultiQueue<T, D, Compare>::tryPopStrict(T& out){
+    for(unsigned int i = 0 ; i < shards.size() ; i++){
+        shards[i]->lock.lock();
+    }
+    Shard* best = NULL;
+    for(unsigned int i = 0 ; i < shards.size() ; i++){
+        if(shards[i]->heap.size() > 0 && (best == NULL || this->compare()(shards[i]->heap.top(), best->heap.top()))){
+            best = shards[i];
+        }
+    }
+    if(best != NULL){
+        out = best->heap.pop();
+        count.fetch_sub(1);
+    }
+    for(unsigned int i = 0 ; i < shards.size() ; i++){
+        shards[i]->lock.unlock();
+    }
+    return best != NULL;
+}
+
+#endif
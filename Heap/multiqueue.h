@@ -0,0 +1,51 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "heap.h"
+
+//A concurrent priority queue made of c*P Heaps (shards), each with its own lock, for P threads
+//push goes to a random shard. pop looks at the tops of two random shards and takes the better one,
+//so it returns an item close to the top but not always the top (relaxed ordering), with little lock contention
+//In strict mode pop locks every shard and always returns the true top, for callers that need exact order
+template<class T, unsigned int D = 4, class Compare = std::less<T> >
+class MultiQueue : private HeapCompare<Compare>{
+    public:
+        //threads: how many threads will use the queue, c: shards per thread
+        MultiQueue(int threads, int c = 2, bool strict = false, const Compare& comp = Compare());
+        ~MultiQueue();
+        //add item to a random shard
+        void push(const T& item);
+        void push(T&& item);
+        //remove an item close to the top (the top in strict mode) and store it in out
+        //returns false if the queue was empty
+        bool tryPop(T& out);
+        //number of items, exact once all threads are done
+        int size() const;
+        bool empty() const;
+        bool isStrict() const;
+    private:
+        //each shard gets its own cache lines so locking one doesn't slow down its neighbors
+        struct alignas(HEAP_CACHE_LINE) Shard{
+            std::mutex lock;
+            Heap<T, D, Compare> heap;
+            Shard(const Compare& comp) : heap(comp){}
+        };
+        std::vector<Shard*> shards;
+        std::atomic<int> count;
+        bool strict;
+
+        //no copying, shards hold mutexes
+        MultiQueue(const MultiQueue& other);
+        MultiQueue& operator=(const MultiQueue& other);
+
+        //random shard index, every thread has its own generator
+        int randomShard() const;
+        //lock a random shard, trying others if it is busy
+        Shard* lockRandomShard();
+        bool tryPopRelaxed(T& out);
+        bool tryPopStrict(T& out);
+};
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef PAIRINGHEAP_CPP
+#define PAIRINGHEAP_CPP
+#include "pairingheap.h"
+#include "heap.cpp"
+#include <new>
+#include <stdexcept>
+
+/*
+  -----------------------------------------
+  Begin implementations for the PairingHeap class.
+  -----------------------------------------
+*/
+
+//Default constructor
+template <class T, class Compare>
+PairingHeap<T, Compare>::PairingHeap(const Compare& comp) : HeapCompare<Compare>(comp), pool(sizeof(Node)){
+    root = NULL;
+    count = 0;
+}
+
+//Move constructor
+template <class T, class Compare>
+PairingHeap<T, Compare>::PairingHeap(PairingHeap&& other) : HeapCompare<Compare>(other.compare()), pool(sizeof(Node)){
+    root = other.root;
+    count = other.count;
+    pool.adopt(other.pool);
+    other.root = NULL;
+    other.count = 0;
+}
+
+//Destructor
+template <class T, class Compare>
+PairingHeap<T, Compare>::~PairingHeap(){
+    destroyAll(root);
+}
+
+/**
+ * Helper for the destructor: runs every node's destructor, the pool frees the memory.
+ * Walks children/siblings with an explicit stack so deep trees can't overflow the call stack
+ * */
+template <class T, class Compare>
+void PairingHeap<T, Compare>::destroyAll(Node* node){
+    std::vector<Node*> stack;
+    if(node != NULL){ stack.push_back(node); }
+    while(!stack.empty()){
+        Node* curr = stack.back();
+        stack.pop_back();
+        if(curr->child != NULL){ stack.push_back(curr->child); }
+        if(curr->sibling != NULL){ stack.push_back(curr->sibling); }
+        curr->~Node();
+    }
+}
+
+template <class T, class Compare>
+int PairingHeap<T, Compare>::size() const{
+    return count;
+}
+
+template <class T, class Compare>
+bool PairingHeap<T, Compare>::empty() const{
+    return count == 0;
+}
+
+template <class T, class Compare>
+inline bool PairingHeap<T, Compare>::before(const T& a, const T& b) const{
+    return this->compare()(a, b);
+}
+
+/**
+ * Helper function: makes the worse of two roots the leftmost child of the better one
+ * Either may be NULL. Returns the new root
+ * */
+template <class T, class Compare>
+typename PairingHeap<T, Compare>::Node* PairingHeap<T, Compare>::link(Node* a, Node* b){
+    if(a == NULL){ return b; }
+    if(b == NULL){ return a; }
+    if(before(b->item, a->item)){
+        Node* temp = a;
+        a = b;
+        b = temp;
+    }
+    b->prev = a;
+    b->sibling = a->child;
+    if(a->child != NULL){ a->child->prev = b; }
+    a->child = b;
+    a->sibling = NULL;
+    a->prev = NULL;
+    return a;
+}
+
+/**
+ * Helper function: the two-pass pairing used by pop. Links siblings in pairs left to right,
+ * then links the pairs right to left into one tree
+ * runtime = amortized log(n)
+ * */
+template <class T, class Compare>
+typename PairingHeap<T, Compare>::Node* PairingHeap<T, Compare>::combineSiblings(Node* first){
+    std::vector<Node*> pairs;
+    while(first != NULL){
+        Node* a = first;
+        Node* b = a->sibling;
+        first = (b == NULL) ? NULL : b->sibling;
+        a->sibling = NULL;
+        a->prev = NULL;
+        if(b != NULL){
+            b->sibling = NULL;
+            b->prev = NULL;
+        }
+        pairs.push_back(link(a, b));
+    }
+    Node* result = NULL;
+    for(int i = (int)pairs.size()-1 ; i >= 0 ; i--){
+        result = link(pairs[i], result);
+    }
+    return result;
+}
+
+template <class T, class Compare>
+typename PairingHeap<T, Compare>::Node* PairingHeap<T, Compare>::insertNode(Node* node){
+    root = link(root, node);
+    count++;
+    return node;
+}
+
+/**
+ * Add new item as a tree of one and link it with the root
+ * runtime = const
+ * */
+template <class T, class Compare>
+typename PairingHeap<T, Compare>::handle PairingHeap<T, Compare>::push(const T& item){
+    return insertNode(new (pool.allocate()) Node(item));
+}
+
+template <class T, class Compare>
+typename PairingHeap<T, Compare>::handle PairingHeap<T, Compare>::push(T&& item){
+    return insertNode(new (pool.allocate()) Node(std::move(item)));
+}
+
+/**
+ * Get topmost value
+ * runtime = const
+ * */
+template <class T, class Compare>
+const T& PairingHeap<T, Compare>::top() const{
+    if(root == NULL){
+        throw emptyHeadException();
+    }
+    return root->item;
+}
+
+/**
+ * Remove the root and pair up its children into the new root
+ * runtime = amortized log(n)
+ * */
+template <class T, class Compare>
+T PairingHeap<T, Compare>::pop(){
+    if(root == NULL){
+        throw emptyHeadException();
+    }
+    Node* old = root;
+    T result = std::move(old->item);
+    root = combineSiblings(old->child);
+    count--;
+    old->~Node();
+    pool.deallocate(old);
+    return result;
+}
+
+/**
+ * Link the two roots. Other's nodes now belong to this heap, so its pool chunks are taken over too
+ * runtime = const (plus other's free list)
+ * */
+template <class T, class Compare>
+void PairingHeap<T, Compare>::merge(PairingHeap&& other){
+    if(&other == this){ return; }
+    root = link(root, other.root);
+    count += other.count;
+    pool.adopt(other.pool);
+    other.root = NULL;
+    other.count = 0;
+}
+
+/**
+ * Cut h's subtree out of the tree and link it back with the root
+ * runtime = const, the cost shows up later in pop (amortized o(log n))
+ * */
+template <class T, class Compare>
+void PairingHeap<T, Compare>::decreaseKey(handle h, const T& item){
+    if(before(h->item, item)){
+        throw std::invalid_argument("decreaseKey can't move an item away from the top");
+    }
+    h->item = item;
+    if(h == root){ return; }
+    //unlink h from its siblings/parent
+    if(h->prev->child == h){
+        h->prev->child = h->sibling;
+    } else {
+        h->prev->sibling = h->sibling;
+    }
+    if(h->sibling != NULL){ h->sibling->prev = h->prev; }
+    h->sibling = NULL;
+    h->prev = NULL;
+    root = link(root, h);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PAIRINGHEAP_H
+#define PAIRINGHEAP_H
+#include <vector>
+#include <functional>
+#include "heap.h"
+#include "../MemoryPool/memorypool.h"
+
+//A MIN HEAP (with the same Compare rules as Heap) made of a tree of nodes instead of an array
+//merge is O(1) and decreaseKey is O(1) amortized-ish (o(log n)), which is much faster than Heap
+//for workloads with lots of melds or priority changes
+template<class T, class Compare = std::less<T> >
+class PairingHeap : private HeapCompare<Compare>{
+    private:
+        struct Node{
+            T item;
+            //leftmost child
+            Node* child;
+            //next sibling to the right
+            Node* sibling;
+            //left sibling, or the parent for a leftmost child. NULL for the root
+            Node* prev;
+            template<class... Args>
+            Node(Args&&... args) : item(std::forward<Args>(args)...), child(NULL), sibling(NULL), prev(NULL){}
+        };
+    public:
+        //refers to an item in the heap until it is popped, used for decreaseKey
+        typedef Node* handle;
+
+        PairingHeap(const Compare& comp = Compare());
+        ~PairingHeap();
+        //move constructor
+        PairingHeap(PairingHeap&& other);
+        //add item to the heap
+        handle push(const T& item);
+        handle push(T&& item);
+        //get the top element
+        const T& top() const;
+        //remove the topmost element and return it
+        T pop();
+        int size() const;
+        bool empty() const;
+        //move all of other's items into this heap in O(1), other is left empty
+        void merge(PairingHeap&& other);
+        //change the item of h to one closer to the top
+        void decreaseKey(handle h, const T& item);
+    private:
+        Node* root;
+        int count;
+        //every node comes from here, one slot each
+        MemoryPool pool;
+
+        //no copying, nodes belong to the pool
+        PairingHeap(const PairingHeap& other);
+        PairingHeap& operator=(const PairingHeap& other);
+
+        //true if a belongs closer to the top than b
+        bool before(const T& a, const T& b) const;
+        //link two roots, the worse one becomes the first child of the better one
+        Node* link(Node* a, Node* b);
+        //pair up a list of siblings and combine them into one tree
+        Node* combineSiblings(Node* first);
+        //insert a new node as a tree of one
+        Node* insertNode(Node* node);
+        //destroy every node in the subtree (used by the destructor)
+        void destroyAll(Node* node);
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef RADIXHEAP_CPP
+#define RADIXHEAP_CPP
+#include "radixheap.h"
+#include "heap.cpp"
+#include <string>
+
+/**
+ * Customized exception to throw when a key smaller than the last popped key is pushed
+ * */
+class monotoneException : public std::exception{
+    public:
+        monotoneException(){
+            msg_ = "Key is smaller than the last popped key";
+        }
+        virtual const char* what() const noexcept{
+            return msg_.c_str();
+        }
+    protected:
+        std::string msg_;
+};
+
+
+//Default constructor
+template <class Key, class Value>
+RadixHeap<Key, Value>::RadixHeap(){
+    last = 0;
+    count = 0;
+    cachedValid = false;
+    cachedBucket = 0;
+    cachedIndex = 0;
+}
+
+template <class Key, class Value>
+int RadixHeap<Key, Value>::size() const{
+    return count;
+}
+
+template <class Key, class Value>
+bool RadixHeap<Key, Value>::empty() const{
+    return count == 0;
+}
+
+/**
+ * Helper function: 0 if key equals last, otherwise 1 + the index of the highest bit where they differ
+ * */
+template <class Key, class Value>
+int RadixHeap<Key, Value>::bucketOf(Key key) const{
+    Key diff = key ^ last;
+    if(diff == 0){ return 0; }
+    return 64 - __builtin_clzll((unsigned long long)diff);
+}
+
+/**
+ * Add an item to its bucket
+ * runtime = const
+ * */
+template <class Key, class Value>
+void RadixHeap<Key, Value>::push(Key key, const Value& value){
+    if(key < last){
+        throw monotoneException();
+    }
+    int b = bucketOf(key);
+    buckets[b].push_back(std::make_pair(key, value));
+    count++;
+    pushed(b);
+}
+
+template <class Key, class Value>
+void RadixHeap<Key, Value>::push(Key key, Value&& value){
+    if(key < last){
+        throw monotoneException();
+    }
+    int b = bucketOf(key);
+    buckets[b].push_back(std::make_pair(key, std::move(value)));
+    count++;
+    pushed(b);
+}
+
+/**
+ * Helper function for push: the cached top stays right unless the new item is smaller
+ * */
+template <class Key, class Value>
+void RadixHeap<Key, Value>::pushed(int b){
+    if(cachedValid && buckets[b].back().first < buckets[cachedBucket][cachedIndex].first){
+        cachedBucket = b;
+        cachedIndex = buckets[b].size() - 1;
+    }
+}
+
+/**
+ * Helper function: last just moved up to the smallest key, which came out of bucket b. Relative to
+ * the new last every other item of b lands in a lower bucket, the ones with the same key in bucket 0
+ * runtime = size of bucket b, and an item can only move down ~bits(Key) times
+ * */
+template <class Key, class Value>
+void RadixHeap<Key, Value>::spread(int b){
+    for(unsigned int i = 0 ; i < buckets[b].size() ; i++){
+        int to = bucketOf(buckets[b][i].first);
+        buckets[to].push_back(std::move(buckets[b][i]));
+    }
+    buckets[b].clear();
+}
+
+/**
+ * Get the item with the smallest key
+ * Only looks, without moving last: a push between last and the smallest key is still valid after it.
+ * The lowest non-empty bucket holds the smallest key (all of bucket 0 if that is it), and the
+ * result is cached until the next pop, so repeated calls don't scan again
+ * runtime = O(size of the lowest non-empty bucket), const while cached
+ * */
+template <class Key, class Value>
+const std::pair<Key, Value>& RadixHeap<Key, Value>::top() const{
+    if(count == 0){
+        throw emptyHeadException();
+    }
+    if(!cachedValid){
+        int b = 0;
+        while(buckets[b].empty()){
+            b++;
+        }
+        unsigned int best = buckets[b].size() - 1;
+        if(b > 0){
+            for(unsigned int i = 0 ; i < buckets[b].size() ; i++){
+                if(buckets[b][i].first < buckets[b][best].first){ best = i; }
+            }
+        }
+        cachedBucket = b;
+        cachedIndex = best;
+        cachedValid = true;
+    }
+    return buckets[cachedBucket][cachedIndex];
+}
+
+/**
+ * Pop off the item with the smallest key: exactly the one top() returns, also among equal keys.
+ * It is swapped with the back of its bucket and taken off. From any bucket but 0 it becomes the
+ * new last and the rest of its bucket is spread out below it
+ * runtime = amortized log(C)
+ * */
+template <class Key, class Value>
+std::pair<Key, Value> RadixHeap<Key, Value>::pop(){
+    top();
+    std::vector<std::pair<Key, Value> >& bucket = buckets[cachedBucket];
+    std::pair<Key, Value> result = std::move(bucket[cachedIndex]);
+    if(cachedIndex + 1 != bucket.size()){
+        bucket[cachedIndex] = std::move(bucket.back());
+    }
+    bucket.pop_back();
+    if(cachedBucket > 0){
+        last = result.first;
+        spread(cachedBucket);
+    }
+    count--;
+    cachedValid = false;
+    return result;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+#include <vector>
+#include <utility>
+#include <climits>
+#include <type_traits>
+
+//A MIN HEAP for unsigned integer keys that are popped in non-decreasing order (Dijkstra with integer
+//weights, timers, ...). A pushed key can't be smaller than the last popped key.
+//Items are put in bucket b where b is the highest bit in which the key differs from the last popped key,
+//so bucket b only holds keys at most 2^b above it. Popping empties the lowest non-empty bucket into lower
+//buckets, and every item can only move down ~bits(Key) times, so operations are amortized O(log C)
+//where C is the largest key difference, with plain appends to vectors instead of sifting
+template<class Key, class Value>
+class RadixHeap{
+    static_assert(std::is_unsigned<Key>::value && sizeof(Key) <= 8, "RadixHeap keys must be unsigned integers of at most 64 bits");
+    public:
+        RadixHeap();
+        //add value with priority key, key can't be smaller than the last popped key
+        void push(Key key, const Value& value);
+        void push(Key key, Value&& value);
+        //get the item with the smallest key
+        const std::pair<Key, Value>& top() const;
+        //remove the item with the smallest key and return it
+        std::pair<Key, Value> pop();
+        int size() const;
+        bool empty() const;
+    private:
+        static const int BITS = sizeof(Key) * CHAR_BIT;
+        //bucket 0 holds keys equal to last, bucket b holds keys whose highest bit differing from last is b-1
+        std::vector<std::pair<Key, Value> > buckets[BITS + 1];
+        //key of the last popped item. Only pop() moves it, so top() never raises the bound push() checks
+        Key last;
+        int count;
+        //where top() found the smallest item, kept until the next pop (push moves it to a smaller new item).
+        //pop() takes this item, so ties come out in the order top() shows them
+        mutable bool cachedValid;
+        mutable int cachedBucket;
+        mutable unsigned int cachedIndex;
+
+        //bucket key belongs in, relative to last
+        int bucketOf(Key key) const;
+        //move the items of bucket b down after last moved up to a key from it
+        void spread(int b);
+        //remember a newly pushed item in bucket b if it is smaller than the cached top
+        void pushed(int b);
+};
+
+#endif
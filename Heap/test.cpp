@@ -1,32 +1,368 @@
 #include "heap.h"
 #include "heap.cpp"
+#include "indexedheap.h"
+#include "indexedheap.cpp"
+#include "multiqueue.h"
+#include "multiqueue.cpp"
+#include "radixheap.h"
+#include "radixheap.cpp"
+#include "pairingheap.h"
+#include "pairingheap.cpp"
+#include "externalheap.h"
+#include "externalheap.cpp"
+#include "topk.h"
+#include "topk.cpp"
+#include <thread>
 #include <vector>
+#include <string>
+#include <list>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <random>
+#include <set>
 
 using namespace std;
+
+//the range constructor only takes iterators, two integers don't pick it
+static_assert(!is_constructible<Heap<int>, int, int>::value, "Heap(4, 2) must not pick the range constructor");
+static_assert(is_constructible<Heap<int>, list<int>::iterator, list<int>::iterator>::value, "ranges of any iterator");
+static_assert(is_constructible<Heap<int>, const int*, const int*>::value, "pointers are iterators too");
+
+//orders strings by length only, so the heap never needs a wrapper struct around them
+struct ByLength{
+    bool operator()(const string& a, const string& b) const{ return a.size() < b.size(); }
+};
+
+/**
+ * Prints what failed, returns 1 so callers can add it to their count of failed checks
+ * */
+int check(bool ok, const string& what){
+    if(!ok){
+        cout << "FAILED: " << what << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Two items in memory, so more than EXTERNAL_HEAP_MAX_RUNS * EXTERNAL_HEAP_MAX_RUNS spills: level 0
+ * runs are merged into level 1 runs and those into a level 2 run, with some pops in between so
+ * partly read runs get merged too. Open runs must stay bounded and everything comes out sorted
+ * returns the number of failed checks
+ * */
+int externalHeapTiersTest(){
+    int failed = 0;
+    const int spills = EXTERNAL_HEAP_MAX_RUNS * EXTERNAL_HEAP_MAX_RUNS + 500;
+    ExternalHeap<int> eh(2, 2);
+    mt19937 rng(7);
+    multiset<int> expected;
+    int mostRuns = 0;
+    for(int i = 0 ; i < 2 * spills ; i++){
+        int item = rng() % 100000;
+        eh.push(item);
+        expected.insert(item);
+        if(i % 1000 == 999){
+            if(eh.pop() != *expected.begin()){ failed++; }
+            expected.erase(expected.begin());
+        }
+        mostRuns = max(mostRuns, eh.runCount());
+    }
+    //at most EXTERNAL_HEAP_MAX_RUNS - 1 runs in each of levels 0, 1 and 2
+    if(mostRuns >= 3 * EXTERNAL_HEAP_MAX_RUNS){ failed++; }
+    for(multiset<int>::iterator it = expected.begin() ; it != expected.end() ; ++it){
+        if(eh.empty() || eh.pop() != *it){
+            failed++;
+            break;
+        }
+    }
+    if(!eh.empty()){ failed++; }
+    return failed;
+}
+
+/**
+ * Relaxed mode (the default, two-choice pops) with pushers and poppers running at once:
+ * the order is only approximate, but every pushed item must come out exactly once
+ * returns the number of failed checks
+ * */
+int relaxedMultiQueueTest(){
+    const int THREADS = 4;
+    const int PER_THREAD = 20000;
+    MultiQueue<int> mq(THREADS);
+    atomic<bool> pushersDone(false);
+    vector<vector<int> > popped(THREADS);
+    vector<thread> poppers;
+    for(int t = 0 ; t < THREADS ; t++){
+        poppers.push_back(thread([&mq, &pushersDone, &popped, t](){
+            int item;
+            while(true){
+                //read before the pop: once every push is done, an empty pop means an empty queue
+                bool finished = pushersDone.load();
+                if(mq.tryPop(item)){
+                    popped[t].push_back(item);
+                } else if(finished){
+                    break;
+                }
+            }
+        }));
+    }
+    vector<thread> pushers;
+    for(int t = 0 ; t < THREADS ; t++){
+        pushers.push_back(thread([&mq, t](){
+            for(int i = 0 ; i < PER_THREAD ; i++){
+                mq.push(i*THREADS + t);
+            }
+        }));
+    }
+    for(int t = 0 ; t < THREADS ; t++){
+        pushers[t].join();
+    }
+    pushersDone = true;
+    for(int t = 0 ; t < THREADS ; t++){
+        poppers[t].join();
+    }
+
+    int failed = 0;
+    vector<int> seen(THREADS * PER_THREAD, 0);
+    for(int t = 0 ; t < THREADS ; t++){
+        for(unsigned int i = 0 ; i < popped[t].size() ; i++){
+            int item = popped[t][i];
+            if(item < 0 || item >= THREADS * PER_THREAD){
+                failed++;
+            } else {
+                seen[item]++;
+            }
+        }
+    }
+    for(unsigned int i = 0 ; i < seen.size() ; i++){
+        if(seen[i] != 1){ failed++; }
+    }
+    failed += check(mq.empty() && mq.size() == 0, "relaxed multiqueue is not empty after draining");
+    return failed;
+}
+
 int main(){
+    int failed = 0;
     Heap<int> h = Heap<int>();
     vector<int> ex = {9, 8, -1, -500, 90, 0, -59, 0, 0, -1, -1, 500, -59, 8};
+    vector<int> sortedEx = ex;
+    sort(sortedEx.begin(), sortedEx.end());
     for(vector<int>::iterator it = ex.begin() ; it != ex.end(); it++){
         h.push(*it);
         h.printHeap();
     }
 
     cout << "Finished building the heap" << endl << endl;
+    vector<int> out;
     try{
         while(1){
             //h.printHeap();
             int temp = h.top();
             cout << temp << endl;
+            out.push_back(temp);
             h.pop();
         }
     } catch(exception &e){
         cout << "end of heap reached" << endl;
     }
-    
+    failed += check(out == sortedEx, "heap pops in sorted order");
 
+    //heap of strings: items are moved in and out instead of copied
+    Heap<string, 4> words;
+    string w = "pear";
+    words.push(w);
+    words.push(string("apple"));
+    words.emplace(3, 'z');
+    words.emplace("banana");
+    cout << "smallest word: " << words.top() << endl;
+    vector<string> wordOrder;
+    while(words.size() > 0){
+        string next = words.pop();
+        cout << next << endl;
+        wordOrder.push_back(next);
+    }
+    failed += check(wordOrder == vector<string>({"apple", "banana", "pear", "zzz"}), "4-ary heap of strings");
 
+    //bulk construction from a list and merging two heaps
+    list<int> lst = {5, 3, 9, 1, 7};
+    Heap<int> built(lst.begin(), lst.end());
+    Heap<int> other(ex);
+    built.merge(std::move(other));
+    built.pushRange(ex.begin(), ex.begin()+3);
+    vector<int> mergedExpected(lst.begin(), lst.end());
+    mergedExpected.insert(mergedExpected.end(), ex.begin(), ex.end());
+    mergedExpected.insert(mergedExpected.end(), ex.begin(), ex.begin()+3);
+    sort(mergedExpected.begin(), mergedExpected.end());
+    out.clear();
+    cout << "merged heap:" << endl;
+    while(built.size() > 0){
+        out.push_back(built.pop());
+        cout << out.back() << " ";
+    }
+    cout << endl;
+    failed += check(out == mergedExpected, "range construction, merge and pushRange");
 
+    //max heap and a heap ordered by a key extractor, both through the comparator
+    Heap<int, 2, greater<int> > maxHeap(ex.begin(), ex.end());
+    out.clear();
+    cout << "max heap:" << endl;
+    while(maxHeap.size() > 0){
+        out.push_back(maxHeap.pop());
+        cout << out.back() << " ";
+    }
+    cout << endl;
+    failed += check(out == vector<int>(sortedEx.rbegin(), sortedEx.rend()), "max heap pops in decreasing order");
+    Heap<string, 4, ByLength> byLength;
+    byLength.push("three");
+    byLength.push("a");
+    byLength.push("seventeen");
+    byLength.push("four");
+    cout << "shortest word: " << byLength.top() << endl;
+    failed += check(byLength.top() == "a", "heap with a custom comparator");
 
+    //indexed heap: handles 0-4, change priorities in place
+    IndexedHeap<int> ih;
+    int prio[5] = {50, 40, 30, 20, 10};
+    for(int i = 0 ; i < 5 ; i++){
+        ih.push(i, prio[i]);
+    }
+    ih.decreaseKey(0, 5);
+    ih.increaseKey(4, 45);
+    ih.erase(2);
+    vector<int> handles;
+    cout << "indexed heap handles:" << endl;
+    while(!ih.empty()){
+        cout << ih.topHandle() << "(" << ih.top() << ") ";
+        handles.push_back(ih.topHandle());
+        ih.pop();
+    }
+    cout << endl;
+    failed += check(handles == vector<int>({0, 3, 1, 4}), "indexed heap decreaseKey, increaseKey and erase");
+
+    //radix heap: timers popped in time order
+    RadixHeap<unsigned int, string> timers;
+    timers.push(30, "c");
+    timers.push(10, "a");
+    timers.push(20, "b");
+    string timerOrder = timers.pop().second;
+    timers.push(15, "d");
+    while(!timers.empty()){
+        timerOrder += timers.pop().second;
+    }
+    cout << "radix heap: " << timerOrder << endl;
+    failed += check(timerOrder == "adbc", "radix heap pops in key order");
+    //top() only looks: a key between the last popped key and the current top can still be pushed
+    timers.push(50, "f");
+    failed += check(timers.top().second == "f", "radix heap top");
+    try{
+        timers.push(40, "e");
+        timers.push(35, "e");
+        failed += check(timers.top().first == 35 && timers.pop().first == 35 && timers.pop().first == 40 && timers.pop().first == 50,
+                        "radix heap pops keys pushed after top() in order");
+    } catch(monotoneException& e){
+        failed += check(false, "radix heap refused a key above the last popped key after top()");
+    }
+    //with equal keys pop() takes the item top() showed, in bucket 0 and in higher buckets
+    RadixHeap<unsigned int, string> ties;
+    ties.push(5, "a");
+    ties.push(5, "b");
+    ties.push(7, "c");
+    ties.push(9, "d");
+    ties.push(9, "e");
+    bool sameAsTop = true;
+    string tieOrder;
+    while(!ties.empty()){
+        pair<unsigned int, string> peeked = ties.top();
+        pair<unsigned int, string> popped = ties.pop();
+        sameAsTop = sameAsTop && peeked == popped;
+        tieOrder += popped.second;
+        if(tieOrder.size() == 1){
+            //equal to last, so it goes to bucket 0 next to the other 5
+            ties.push(5, "f");
+        }
+    }
+    failed += check(sameAsTop && tieOrder.size() == 6, "radix heap pops the item top() returned among equal keys");
+
+    //pairing heap: meld two heaps and move an item up with decreaseKey
+    PairingHeap<int> ph;
+    PairingHeap<int> ph2;
+    PairingHeap<int>::handle h90 = ph.push(90);
+    for(vector<int>::iterator it = ex.begin() ; it != ex.end(); it++){
+        ph2.push(*it);
+    }
+    ph.push(7);
+    ph.merge(std::move(ph2));
+    ph.decreaseKey(h90, -1000);
+    vector<int> pairingExpected = ex;
+    pairingExpected.push_back(7);
+    pairingExpected.push_back(-1000);
+    sort(pairingExpected.begin(), pairingExpected.end());
+    out.clear();
+    cout << "pairing heap:" << endl;
+    while(!ph.empty()){
+        out.push_back(ph.pop());
+        cout << out.back() << " ";
+    }
+    cout << endl;
+    failed += check(out == pairingExpected, "pairing heap merge and decreaseKey");
 
+    //external heap: only 4 items fit in memory, the rest is spilled to sorted runs on disk
+    ExternalHeap<int> eh(4, 2);
+    for(vector<int>::iterator it = ex.begin() ; it != ex.end(); it++){
+        eh.push(*it);
+    }
+    failed += check(eh.runCount() > 0, "external heap spills to disk");
+    out.clear();
+    cout << "external heap with " << eh.runCount() << " runs:" << endl;
+    while(!eh.empty()){
+        out.push_back(eh.pop());
+        cout << out.back() << " ";
+    }
+    cout << endl;
+    failed += check(out == sortedEx, "external heap pops in sorted order");
+    failed += check(externalHeapTiersTest() == 0, "external heap merges runs level by level");
+
+    //top-k: the 3 largest numbers of ex
+    TopK<int> top3(3);
+    top3.offer(ex.begin(), ex.end());
+    vector<int> best = top3.extract();
+    cout << "top 3:";
+    for(unsigned int i = 0 ; i < best.size() ; i++){
+        cout << " " << best[i];
+    }
+    cout << endl;
+    sort(best.begin(), best.end());
+    failed += check(best == vector<int>({9, 90, 500}), "top-k keeps the 3 largest");
+
+    //concurrent queue: 4 threads push 1000 items each, then everything is popped in strict order
+    MultiQueue<int> mq(4, 2, true);
+    vector<thread> pushers;
+    for(int t = 0 ; t < 4 ; t++){
+        pushers.push_back(thread([&mq, t](){
+            for(int i = 0 ; i < 1000 ; i++){
+                mq.push(i*4 + t);
+            }
+        }));
+    }
+    for(int t = 0 ; t < 4 ; t++){
+        pushers[t].join();
+    }
+    int expected = 0;
+    int item;
+    while(mq.tryPop(item)){
+        if(item != expected){ break; }
+        expected++;
+    }
+    cout << "multiqueue popped " << expected << " of 4000 items in order" << endl;
+    failed += check(expected == 4000 && mq.empty(), "strict multiqueue pops every item in order");
+
+    failed += check(relaxedMultiQueueTest() == 0, "relaxed multiqueue pops every item exactly once");
+
+    if(failed != 0){
+        cout << failed << " heap checks FAILED" << endl;
+        return 1;
+    }
+    cout << "all heap checks passed" << endl;
     return 0;
-}
\ No newline at end of file
+}
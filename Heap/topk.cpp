@@ -0,0 +1,73 @@
+#ifndef TOPK_CPP
+#define TOPK_CPP
+#include "topk.h"
+#include "heap.cpp"
+#include <algorithm>
+
+
+//Constructor
+template <class T, class Compare>
+TopK<T, Compare>::TopK(int k, const Compare& comp) : HeapCompare<Compare>(comp), kept(comp){
+    if(k < 0){ k = 0; }
+    this->k = k;
+}
+
+template <class T, class Compare>
+int TopK<T, Compare>::size() const{
+    return kept.size();
+}
+
+template <class T, class Compare>
+const T& TopK<T, Compare>::threshold() const{
+    return kept.top();
+}
+
+/**
+ * Keep item if there is room or if it beats the smallest kept item
+ * runtime = const if rejected, log(K) if kept
+ * */
+template <class T, class Compare>
+void TopK<T, Compare>::offer(const T& item){
+    if(kept.size() < k){
+        kept.push(item);
+    } else if(k > 0 && this->compare()(kept.top(), item)){
+        kept.replaceTop(item);
+    }
+}
+
+/**
+ * Batched offer: fills up to K first, after that each candidate costs one comparison
+ * against the current threshold unless it gets in
+ * runtime = O(n log K)
+ * */
+template <class T, class Compare>
+template <class InputIt>
+void TopK<T, Compare>::offer(InputIt first, InputIt last){
+    for( ; first != last && kept.size() < k ; ++first){
+        kept.push(*first);
+    }
+    if(k == 0){ return; }
+    const Compare& comp = this->compare();
+    for( ; first != last ; ++first){
+        if(comp(kept.top(), *first)){
+            kept.replaceTop(*first);
+        }
+    }
+}
+
+/**
+ * Pops the kept items (smallest first) and reverses them
+ * runtime = O(K log K)
+ * */
+template <class T, class Compare>
+std::vector<T> TopK<T, Compare>::extract(){
+    std::vector<T> result;
+    result.reserve(kept.size());
+    while(kept.size() > 0){
+        result.push_back(kept.pop());
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+#endif
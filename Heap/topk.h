@@ -0,0 +1,31 @@
+#ifndef TOPK_H
+#define TOPK_H
+#include <vector>
+#include <functional>
+#include "heap.h"
+
+//Keeps the K largest items (by Compare, so std::less keeps the K biggest) seen in a stream
+//The kept items are in a size-K Heap whose top is the smallest of them, so a candidate that can't get in
+//is rejected with one comparison against top(), and one that can replaces the top with one sift
+//Selecting from n items costs O(n log K) time and O(K) memory
+template<class T, class Compare = std::less<T> >
+class TopK : private HeapCompare<Compare>{
+    public:
+        TopK(int k, const Compare& comp = Compare());
+        //consider one item
+        void offer(const T& item);
+        //consider every item in the range (a container, a pointer range, ...)
+        template<class InputIt>
+        void offer(InputIt first, InputIt last);
+        //number of items kept so far (at most K)
+        int size() const;
+        //smallest kept item, the one a candidate has to beat once K items are kept
+        const T& threshold() const;
+        //the kept items, largest first. The selector is empty afterwards
+        std::vector<T> extract();
+    private:
+        int k;
+        Heap<T, 4, Compare> kept;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+
+#include <cstddef>
+#include <vector>
+#include <new>
+
+//the first chunk holds this many slots, every next chunk twice as many up to the max
+const std::size_t POOL_FIRST_CHUNK = 64;
+const std::size_t POOL_MAX_CHUNK = 65536;
+
+/**
+ * Fixed-size slots carved one after the other out of large contiguous chunks.
+ * A freed slot goes on a free list and is handed out again by the next allocate(),
+ * and release() gives all chunks back to the system at once, in O(chunks) instead of
+ * one free() per slot. Not thread safe.
+ * Used by PoolAllocator in ../BST (one pool per slot size) and directly by PairingHeap in ../Heap.
+ */
+class MemoryPool
+{
+public:
+    //slotSize must be at least sizeof(void*) and a multiple of the alignment the slots need
+    explicit MemoryPool(std::size_t slotSize);
+    ~MemoryPool();
+
+    //raw memory for one slot, the caller constructs the object
+    void* allocate();
+    //the object in p must already be destroyed
+    void deallocate(void* p);
+    //frees every chunk at once. Every object in the pool must already be destroyed
+    void release();
+    //makes sure the next n allocations come out of one chunk, one after the other
+    void reserve(std::size_t n);
+    //takes over other's chunks and free slots, other ends up empty. What other handed out is now this pool's
+    void adopt(MemoryPool& other);
+    std::size_t slotSize() const;
+
+private:
+    //a free slot's memory is reused as the link in the free list
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+    std::vector<char*> chunks_;
+    FreeSlot* freeList_;
+    //next unused slot in the newest chunk and how many are left in it
+    char* next_;
+    std::size_t left_;
+    //size of the next chunk, doubles up to POOL_MAX_CHUNK
+    std::size_t chunkSize_;
+    std::size_t slotSize_;
+
+    //no copying, the chunks belong to one pool
+    MemoryPool(const MemoryPool& other);
+    MemoryPool& operator=(const MemoryPool& other);
+    //puts the unused rest of the newest chunk on the free list
+    void freeRest();
+};
+
+/*
+  ------------------------------------------------
+  Begin implementations for the MemoryPool class.
+  ------------------------------------------------
+*/
+
+inline MemoryPool::MemoryPool(std::size_t slotSize) :
+    freeList_(NULL),
+    next_(NULL),
+    left_(0),
+    chunkSize_(POOL_FIRST_CHUNK),
+    slotSize_(slotSize)
+{
+
+}
+
+inline MemoryPool::~MemoryPool()
+{
+    release();
+}
+
+inline std::size_t MemoryPool::slotSize() const
+{
+    return slotSize_;
+}
+
+/**
+ * Reuses a freed slot if there is one, otherwise takes the next slot of the newest chunk.
+ * runtime = const (amortized, a new chunk is allocated once every chunkSize_ slots)
+ */
+inline void* MemoryPool::allocate()
+{
+    if(freeList_ != NULL){
+        FreeSlot* slot = freeList_;
+        freeList_ = slot->next;
+        return slot;
+    }
+    if(left_ == 0){
+        next_ = (char*)::operator new(chunkSize_ * slotSize_);
+        chunks_.push_back(next_);
+        left_ = chunkSize_;
+        if(chunkSize_ < POOL_MAX_CHUNK){ chunkSize_ *= 2; }
+    }
+    void* slot = next_;
+    next_ += slotSize_;
+    left_--;
+    return slot;
+}
+
+inline void MemoryPool::deallocate(void* p)
+{
+    FreeSlot* slot = (FreeSlot*)p;
+    slot->next = freeList_;
+    freeList_ = slot;
+}
+
+/**
+ * Gives all chunks back and starts over with a small first chunk.
+ * runtime = number of chunks, which is O(log n) while chunks are still doubling
+ */
+inline void MemoryPool::release()
+{
+    for(std::size_t i = 0 ; i < chunks_.size() ; i++){
+        ::operator delete(chunks_[i]);
+    }
+    chunks_.clear();
+    freeList_ = NULL;
+    next_ = NULL;
+    left_ = 0;
+    chunkSize_ = POOL_FIRST_CHUNK;
+}
+
+inline void MemoryPool::freeRest()
+{
+    for( ; left_ > 0 ; left_--){
+        deallocate(next_);
+        next_ += slotSize_;
+    }
+    next_ = NULL;
+}
+
+/**
+ * Allocates one chunk of exactly n slots, unless the newest chunk still has n left.
+ * The slots left over in the old chunk go on the free list, so nothing is lost.
+ * The free list is handed out first, so only a pool without freed slots (like the
+ * pool of an empty tree) hands out the next n slots in order.
+ * runtime = O(slots left in the old chunk)
+ */
+inline void MemoryPool::reserve(std::size_t n)
+{
+    if(n <= left_){
+        return;
+    }
+    freeRest();
+    next_ = (char*)::operator new(n * slotSize_);
+    chunks_.push_back(next_);
+    left_ = n;
+}
+
+/**
+ * The chunks just change hands. other's free slots, and the unused rest of its newest chunk,
+ * go on this pool's free list, so nothing is lost
+ * runtime = O(chunks + free slots of other)
+ */
+inline void MemoryPool::adopt(MemoryPool& other)
+{
+    if(&other == this){
+        return;
+    }
+    chunks_.insert(chunks_.end(), other.chunks_.begin(), other.chunks_.end());
+    other.freeRest();
+    while(other.freeList_ != NULL){
+        FreeSlot* slot = other.freeList_;
+        other.freeList_ = slot->next;
+        deallocate(slot);
+    }
+    other.chunks_.clear();
+    other.chunkSize_ = POOL_FIRST_CHUNK;
+}
+
+/*
+  ----------------------------------------------
+  End implementations for the MemoryPool class.
+  ----------------------------------------------
+*/
+
+#endif